@@ -0,0 +1,243 @@
+/**
+ * Computes lower bounds for many instances and parameter combinations in a
+ * single process. Compared to a process per job, the polygons are read only
+ * once, the Gurobi environment of the CETSP solver is shared, and there is
+ * no startup per job.
+ *
+ *   batch_lower_bounds <manifest.json> [num_workers]
+ *
+ * The manifest lists the instances and a grid of parameters. Every
+ * parameter is a value or an array of values, and every combination is
+ * solved for every instance:
+ *
+ *   {"instances": ["a.poly", ...] and/or "instance_dir": "<dir>",
+ *    "output": "<file>",
+ *    "workers": w (optional), "cetsp_threads": c (optional),
+ *    "offset_tiles": t (optional, tiles per axis for the uncovered regions),
+ *    "raster_resolution": n (optional, estimates the uncovered regions on a grid first),
+ *    "portfolio": [f, ...] (optional, followup strategies solved in parallel, not with
+ *                           "raster_resolution"),
+ *    "parameters": {"initial_strategy": [1, 2], "followup_strategy": 5,
+ *                   "radius": 1, "time": 1800,
+ *                   "max_witness_size_initial": 15, "max_witness_size": 10,
+ *                   "max_iterations": 5}}
+ *
+ * The results are appended to the output file as soon as a job finishes,
+ * one JSON object per line with the instance, the parameters, and the
+ * solution (or an error). Jobs that are already in the output file without
+ * an error are skipped, such that an interrupted batch can be continued.
+ */
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "mowing/LowerBoundSolver.h"
+#include "utils/job_queue.h"
+#include "utils/json_helper.h"
+
+const std::vector<std::string> PARAMETERS = {"initial_strategy", "followup_strategy", "radius", "time",
+                                             "max_witness_size_initial", "max_witness_size", "max_iterations"};
+
+/**
+ * Appends the results to the output file. Can be used from multiple threads.
+ */
+class ResultWriter {
+public:
+    explicit ResultWriter(const std::string &file_name) : outfile(file_name, std::ios::app) {
+        if (!outfile.is_open()) {
+            throw std::runtime_error("Could not open file " + file_name);
+        }
+    }
+
+    void write(const json &result) {
+        std::lock_guard<std::mutex> lock(mutex);
+        outfile << result.dump() << std::endl; // flushes, so the results survive an abort
+    }
+
+private:
+    std::ofstream outfile;
+    std::mutex mutex;
+};
+
+std::string jobKey(const std::string &instance, const json &parameters) {
+    return instance + " " + parameters.dump();
+}
+
+/**
+ * Expands the grid of parameters into all combinations.
+ */
+std::vector<json> expandGrid(const json &grid) {
+    auto combinations = std::vector<json>{json::object()};
+    for (const auto &name: PARAMETERS) {
+        if (!grid.contains(name)) {
+            throw std::invalid_argument("The manifest does not set the parameter " + name);
+        }
+        const auto values = grid[name].is_array() ? grid[name] : json::array({grid[name]});
+        auto expanded = std::vector<json>();
+        for (const auto &combination: combinations) {
+            for (const auto &value: values) {
+                expanded.push_back(combination);
+                expanded.back()[name] = value;
+            }
+        }
+        combinations = std::move(expanded);
+    }
+    return combinations;
+}
+
+std::vector<std::string> listInstances(const json &manifest) {
+    auto instances = std::vector<std::string>();
+    if (manifest.contains("instances")) {
+        for (const auto &instance: manifest["instances"]) {
+            instances.push_back(instance.get<std::string>());
+        }
+    }
+    if (manifest.contains("instance_dir")) {
+        auto files = std::vector<std::string>();
+        for (const auto &entry: std::filesystem::directory_iterator(manifest["instance_dir"].get<std::string>())) {
+            if (entry.path().extension() == ".poly") {
+                files.push_back(entry.path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+        instances.insert(instances.end(), files.begin(), files.end());
+    }
+    return instances;
+}
+
+/**
+ * Reads the jobs that are already in the output file.
+ */
+std::set<std::string> readFinishedJobs(const std::string &file_name) {
+    auto finished = std::set<std::string>();
+    std::ifstream input_file(file_name);
+    std::string line;
+    while (std::getline(input_file, line)) {
+        try {
+            auto result = json::parse(line);
+            if (!result.contains("error")) {
+                finished.insert(jobKey(result.at("instance").get<std::string>(), result.at("parameters")));
+            }
+        } catch (json::exception &) {
+            // A line of an aborted run, the job is repeated.
+        }
+    }
+    return finished;
+}
+
+json solveLowerBound(const std::string &polygon_line, const json &parameters, unsigned cetsp_threads,
+                     std::size_t offset_tiles, std::size_t raster_resolution, const std::vector<int> &portfolio) {
+    // Every job parses its own polygon, as the exact numbers must not be shared between threads.
+    Polygon_2 polygon;
+    std::stringstream ss;
+    ss << polygon_line;
+    ss >> polygon;
+
+    auto solver = mowing::LowerBoundSolver(polygon,
+                                           parameters.at("initial_strategy").get<int>(),
+                                           parameters.at("followup_strategy").get<int>(),
+                                           parameters.at("radius").get<double>(),
+                                           parameters.at("time").get<double>(),
+                                           parameters.at("max_witness_size_initial").get<std::size_t>(),
+                                           parameters.at("max_witness_size").get<std::size_t>(),
+                                           parameters.at("max_iterations").get<std::size_t>());
+    solver.setCETSPThreads(cetsp_threads);
+    if (offset_tiles > 1) {
+        solver.setOffsetTiling(offset_tiles, cetsp_threads);
+    }
+    if (raster_resolution > 0) {
+        solver.enableRasterEstimation(raster_resolution);
+    }
+    if (!portfolio.empty()) {
+        solver.enablePortfolio(portfolio, cetsp_threads);
+    }
+    auto solution = solver.solve();
+    return toJson(solution);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cout << "Usage: batch_lower_bounds <manifest.json> [num_workers]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream manifest_file(argv[1]);
+    if (!manifest_file.is_open()) {
+        std::cout << "Could not open file " << argv[1] << std::endl;
+        return 1;
+    }
+    const auto manifest = json::parse(manifest_file);
+
+    const auto hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned num_workers = std::max(1u, manifest.value("workers", hardware_threads / 4));
+    if (argc == 3) {
+        num_workers = std::max(1, std::stoi(argv[2]));
+    }
+    // The workers share the hardware threads.
+    const unsigned cetsp_threads = manifest.value("cetsp_threads", std::max(1u, hardware_threads / num_workers));
+    const std::size_t offset_tiles = manifest.value("offset_tiles", std::size_t(1));
+    const std::size_t raster_resolution = manifest.value("raster_resolution", std::size_t(0));
+    const auto portfolio = manifest.value("portfolio", std::vector<int>());
+    if (raster_resolution > 0 && !portfolio.empty()) {
+        std::cout << "The portfolio cannot be combined with the raster estimation" << std::endl;
+        return 1;
+    }
+
+    const auto output = manifest.at("output").get<std::string>();
+    const auto combinations = expandGrid(manifest.at("parameters"));
+    const auto finished = readFinishedJobs(output);
+
+    // Every polygon is read only once.
+    auto polygon_lines = std::map<std::string, std::string>();
+    for (const auto &instance: listInstances(manifest)) {
+        std::ifstream input_file(instance);
+        if (!input_file.is_open()) {
+            std::cout << "Could not open file " << instance << std::endl;
+            continue;
+        }
+        std::getline(input_file, polygon_lines[instance]);
+    }
+
+    ResultWriter writer(output);
+    JobQueue queue(num_workers);
+    std::size_t num_jobs = 0;
+    for (const auto &entry: polygon_lines) {
+        const auto &instance = entry.first;
+        const auto &polygon_line = entry.second;
+        for (const auto &parameters: combinations) {
+            if (finished.count(jobKey(instance, parameters))) {
+                continue;
+            }
+            ++num_jobs;
+            queue.push([&writer, &instance, &polygon_line, &parameters, cetsp_threads, offset_tiles,
+                        raster_resolution, &portfolio]() {
+                json result;
+                result["instance"] = instance;
+                result["parameters"] = parameters;
+                try {
+                    result["solution"] = solveLowerBound(polygon_line, parameters, cetsp_threads, offset_tiles,
+                                                         raster_resolution, portfolio);
+                } catch (std::exception &ex) {
+                    result["error"] = ex.what();
+                } catch (GRBException &ex) {
+                    result["error"] = "Gurobi error " + std::to_string(ex.getErrorCode()) + ": " + ex.getMessage();
+                }
+                writer.write(result);
+                std::cout << "Finished " << instance << " " << parameters.dump() << std::endl;
+            });
+        }
+    }
+
+    std::cout << "Solving " << num_jobs << " jobs (" << finished.size() << " already finished) on "
+              << num_workers << " workers with " << cetsp_threads << " CETSP threads each" << std::endl;
+    queue.close();
+    return 0;
+}
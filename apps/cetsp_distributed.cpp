@@ -0,0 +1,110 @@
+/**
+ * Distributed CETSP BnB. Start a coordinator and any number of workers, on
+ * the same or different hosts:
+ *
+ *   cetsp_distributed coordinator <address> <instance_file> <time> [local_workers]
+ *   cetsp_distributed worker <address> <time>
+ *
+ * The address is `unix:<path>` or `tcp:<host>:<port>`. The instance file
+ * contains one circle `x y r` per line. With `local_workers`, the coordinator
+ * forks the given number of worker processes itself, which allows testing
+ * on a single machine.
+ */
+#include "cetsp/distributed.h"
+#include "cetsp/heuristics.h"
+#include "cetsp/strategies/rules/global_convex_hull_rule.h"
+#include "cetsp/strategies/rules/layered_convex_hull_rule.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+constexpr double GAP = 0.01;
+
+std::unique_ptr<cetsp::ChFarthestCircle> create_branching_strategy() {
+  auto branching_strategy = std::make_unique<cetsp::ChFarthestCircle>(false, 1);
+  branching_strategy->enable_objective_cutoff(GAP);
+  branching_strategy->add_rule(std::make_unique<cetsp::GlobalConvexHullRule>());
+  branching_strategy->add_rule(
+      std::make_unique<cetsp::LayeredConvexHullRule>());
+  return branching_strategy;
+}
+
+int run_worker(const std::string &address, double time) {
+  cetsp::DistributedWorker worker(address, []() {
+    return std::make_pair<std::unique_ptr<cetsp::BranchingStrategy>,
+                          std::unique_ptr<cetsp::SearchStrategy>>(
+        create_branching_strategy(),
+        std::make_unique<cetsp::CheapestChildDepthFirst>());
+  });
+  const auto num_solved = worker.run(static_cast<int>(time), GAP);
+  std::cout << "Worker explored " << num_solved << " subproblems."
+            << std::endl;
+  return 0;
+}
+
+int run_coordinator(const std::string &address, const std::string &file_name,
+                    double time, int local_workers) {
+  std::ifstream input_file(file_name);
+  if (!input_file.is_open()) {
+    std::cout << "Could not open file " << file_name << std::endl;
+    return 1;
+  }
+  std::vector<cetsp::Circle> circles;
+  double x, y, r;
+  while (input_file >> x >> y >> r) {
+    circles.emplace_back(cetsp::Point(x, y), r);
+  }
+  input_file.close();
+
+  // Fork the local workers before anything else (in particular Gurobi) has
+  // been initialized.
+  std::vector<pid_t> children;
+  for (int i = 0; i < local_workers; ++i) {
+    const auto pid = fork();
+    if (pid == 0) {
+      _exit(run_worker(address, time));
+    }
+    if (pid < 0) {
+      std::cout << "Could not fork worker " << i << std::endl;
+      continue;
+    }
+    children.push_back(pid);
+  }
+
+  cetsp::Instance instance(circles);
+  std::cout << "Instance has " << instance.size() << " circles." << std::endl;
+  cetsp::ConvexHullRoot root_strategy;
+  auto branching_strategy = create_branching_strategy();
+  cetsp::DistributedCoordinator coordinator(
+      &instance, root_strategy.get_root_node(instance), *branching_strategy,
+      address);
+  coordinator.add_upper_bound(cetsp::compute_tour_by_2opt(instance));
+  coordinator.optimize(static_cast<int>(time), GAP,
+                       std::max<size_t>(64, 8 * children.size()));
+  for (const auto &[key, value] : coordinator.get_statistics()) {
+    std::cout << key << ": " << value << std::endl;
+  }
+  for (const auto pid : children) {
+    waitpid(pid, nullptr, 0);
+  }
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc >= 5 && std::string(argv[1]) == "coordinator") {
+    const int local_workers = argc >= 6 ? std::stoi(argv[5]) : 0;
+    return run_coordinator(argv[2], argv[3], atof(argv[4]), local_workers);
+  }
+  if (argc == 4 && std::string(argv[1]) == "worker") {
+    return run_worker(argv[2], atof(argv[3]));
+  }
+  std::cout << "Usage: " << argv[0]
+            << " coordinator <address> <instance_file> <time> "
+               "[local_workers]"
+            << std::endl
+            << "       " << argv[0] << " worker <address> <time>"
+            << std::endl;
+  return 1;
+}
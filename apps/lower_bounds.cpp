@@ -1,6 +1,10 @@
 #include <cstdlib>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 #include <nlohmann/json.hpp>
 #include "utils/utils.hpp"
 #include "mowing/LowerBoundSolver.h"
@@ -17,10 +21,23 @@ void exportJson(const std::string &out_file, mowing::LowerBoundSolver::solution
     std::cout << "Export completed to " << out_file << std::endl;
 }
 
+/**
+ * Parses a comma-separated list of strategy codes, e.g., "3,4,5".
+ */
+std::vector<int> parseStrategies(const std::string &list) {
+    auto strategies = std::vector<int>();
+    std::stringstream ss(list);
+    std::string code;
+    while (std::getline(ss, code, ',')) {
+        strategies.push_back(std::stoi(code));
+    }
+    return strategies;
+}
+
 int main(int argc, char *argv[]) {
 
-    if (argc != 10) {
-        std::cout << "Too few or many arguments" << std::endl;
+    if (argc < 10) {
+        std::cout << "Too few arguments" << std::endl;
         return 0;
     }
 
@@ -56,6 +73,28 @@ int main(int argc, char *argv[]) {
                                            radius, time,
                                            max_witness_size_initial,
                                            max_witness_size, max_iterations);
+
+    // Optional flags after the positional arguments
+    const auto hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 10; i < argc; i++) {
+        std::string flag = argv[i];
+        try {
+            if (flag == "--offset-tiles" && i + 1 < argc) {
+                solver.setOffsetTiling((std::size_t) std::stoul(argv[++i]), hardware_threads);
+            } else if (flag == "--raster" && i + 1 < argc) {
+                solver.enableRasterEstimation((std::size_t) std::stoul(argv[++i]));
+            } else if (flag == "--portfolio" && i + 1 < argc) {
+                solver.enablePortfolio(parseStrategies(argv[++i]), hardware_threads);
+            } else {
+                std::cout << "Unknown argument " << flag << std::endl;
+                return 0;
+            }
+        } catch (std::invalid_argument &ex) {
+            std::cout << "Invalid argument " << flag << ": " << ex.what() << std::endl;
+            return 0;
+        }
+    }
+
     auto solution = solver.solve();
 
     std::cout << "Polygon: " << polygon << std::endl;
@@ -0,0 +1,283 @@
+/**
+ * Long-running solver daemon. Starting a process per CETSP or mowing job
+ * pays the process startup, the creation of the Gurobi environments, and
+ * the allocator warm-up again and again. The daemon keeps all of this warm
+ * and executes the jobs on a pool of worker threads.
+ *
+ *   solver_daemon [unix:<path>] [num_workers]
+ *
+ * Without an address, jobs are read from stdin and the results are written
+ * to stdout (the log output of the solvers is redirected to stderr).
+ * Otherwise, any number of clients can connect to the Unix socket.
+ *
+ * Protocol: One JSON object per line in both directions. Every job has an
+ * `id` chosen by the client, which is copied into the result. Results are
+ * returned as soon as the job finishes, so they may arrive out of order.
+ *
+ *   {"id": 1, "type": "ping"}
+ *   {"id": 2, "type": "cetsp", "points": [[x, y], ...], "radius": r,
+ *    "time": t, "start": [x, y] (optional)}
+ *   {"id": 3, "type": "lower_bound", "polygon": [[x, y], ...] or
+ *    "polygon_file": "<file>", "radius": r, "time": t,
+ *    "initial_strategy": i, "followup_strategy": f,
+ *    "max_witness_size_initial": n, "max_witness_size": m,
+ *    "max_iterations": k, "offset_tiles": t (optional),
+ *    "raster_resolution": n (optional),
+ *    "portfolio": [f, ...] (optional, followup strategies solved in parallel,
+ *    not with "raster_resolution")}
+ *   {"type": "shutdown"}  finishes the running jobs and exits
+ *
+ * Failed jobs are answered with {"id": ..., "error": "<message>"}.
+ *
+ * The workers share the hardware threads: The CETSP solver of every job uses
+ * hardware_concurrency / num_workers threads.
+ */
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <boost/thread/thread.hpp>
+#include <nlohmann/json.hpp>
+#include "cetsp/distributed.h"
+#include "cetsp/solver.h"
+#include "mowing/LowerBoundSolver.h"
+#include "utils/job_queue.h"
+#include "utils/json_helper.h"
+
+/**
+ * Sends the results of the jobs of one client. Can be used from multiple
+ * threads. Owns the file descriptor, such that it stays valid as long as
+ * jobs of the client are running.
+ */
+class ResultChannel {
+public:
+    explicit ResultChannel(int fd) : fd{fd} {}
+    ResultChannel(const ResultChannel &) = delete;
+    ResultChannel &operator=(const ResultChannel &) = delete;
+    ~ResultChannel() { ::close(fd); }
+
+    void send(const json &result) {
+        auto line = result.dump();
+        line.push_back('\n');
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t written = 0;
+        while (written < line.size()) {
+            const auto n = ::write(fd, line.data() + written, line.size() - written);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return; // the client is gone, drop the result.
+            }
+            written += static_cast<size_t>(n);
+        }
+    }
+
+private:
+    int fd;
+    std::mutex mutex;
+};
+
+std::atomic<bool> shutdown_requested{false};
+
+std::vector<CGALPoint> parsePoints(const json &array) {
+    std::vector<CGALPoint> points;
+    for (const auto &p: array) {
+        points.emplace_back(p.at(0).get<double>(), p.at(1).get<double>());
+    }
+    return points;
+}
+
+json pointsToJson(const std::vector<CGALPoint> &points) {
+    json result = json::array();
+    for (const auto &p: points) {
+        result.push_back({CGAL::to_double(p.x()), CGAL::to_double(p.y())});
+    }
+    return result;
+}
+
+json solveCetsp(const json &job, unsigned num_threads) {
+    auto points = parsePoints(job.at("points"));
+    std::shared_ptr<CGALPoint> start_point;
+    if (job.contains("start")) {
+        start_point = std::make_shared<CGALPoint>(job["start"].at(0).get<double>(),
+                                                  job["start"].at(1).get<double>());
+    }
+    auto solution = cetsp::solve(points, start_point, job.at("radius").get<double>(),
+                                 job.at("time").get<double>(), false, num_threads);
+    json result;
+    result["lower_bound"] = solution.lower_bound;
+    result["upper_bound"] = solution.upper_bound;
+    result["optimal"] = solution.optimal_solution_found;
+    result["tour"] = pointsToJson(solution.points);
+    result["sequence"] = solution.sequence;
+    result["statistics"] = solution.statistics;
+    return result;
+}
+
+json solveLowerBound(const json &job, unsigned num_threads) {
+    Polygon_2 polygon;
+    if (job.contains("polygon_file")) {
+        std::ifstream input_file(job["polygon_file"].get<std::string>());
+        if (!input_file.is_open()) {
+            throw std::runtime_error("Could not open file " + job["polygon_file"].get<std::string>());
+        }
+        input_file >> polygon;
+    } else {
+        for (const auto &p: parsePoints(job.at("polygon"))) {
+            polygon.push_back(p);
+        }
+    }
+    auto solver = mowing::LowerBoundSolver(polygon,
+                                           job.at("initial_strategy").get<int>(),
+                                           job.at("followup_strategy").get<int>(),
+                                           job.at("radius").get<double>(),
+                                           job.at("time").get<double>(),
+                                           job.at("max_witness_size_initial").get<std::size_t>(),
+                                           job.at("max_witness_size").get<std::size_t>(),
+                                           job.at("max_iterations").get<std::size_t>());
+    solver.setCETSPThreads(num_threads);
+    if (job.contains("offset_tiles")) {
+        solver.setOffsetTiling(job["offset_tiles"].get<std::size_t>(), num_threads);
+    }
+    if (job.contains("raster_resolution")) {
+        solver.enableRasterEstimation(job["raster_resolution"].get<std::size_t>());
+    }
+    if (job.contains("portfolio")) {
+        solver.enablePortfolio(job["portfolio"].get<std::vector<int>>(), num_threads);
+    }
+    auto solution = solver.solve();
+    return toJson(solution);
+}
+
+/**
+ * Runs a job.
+ * @param num_threads The threads of the CETSP solver, the workers share the hardware threads.
+ */
+json runJob(const json &job, unsigned num_threads) {
+    const auto type = job.at("type").get<std::string>();
+    if (type == "cetsp") {
+        return solveCetsp(job, num_threads);
+    }
+    if (type == "lower_bound") {
+        return solveLowerBound(job, num_threads);
+    }
+    throw std::invalid_argument("Unknown job type " + type);
+}
+
+/**
+ * Parses a line of a client and dispatches the job. Cheap jobs (ping,
+ * shutdown, malformed messages) are answered directly.
+ */
+void dispatch(const std::string &line, const std::shared_ptr<ResultChannel> &channel, JobQueue &queue,
+              unsigned job_threads) {
+    if (line.empty()) {
+        return;
+    }
+    json job;
+    try {
+        job = json::parse(line);
+    } catch (json::exception &ex) {
+        channel->send({{"error", std::string("Malformed job: ") + ex.what()}});
+        return;
+    }
+    const auto id = job.value("id", json());
+    const auto type = job.value("type", std::string());
+    if (type == "ping") {
+        channel->send({{"id", id}, {"pong", true}});
+        return;
+    }
+    if (type == "shutdown") {
+        shutdown_requested = true;
+        return;
+    }
+    queue.push([job = std::move(job), id, channel, job_threads]() {
+        json result;
+        try {
+            result = runJob(job, job_threads);
+        } catch (std::exception &ex) {
+            result = {{"error", ex.what()}};
+        } catch (GRBException &ex) {
+            result = {{"error", "Gurobi error " + std::to_string(ex.getErrorCode()) + ": " + ex.getMessage()}};
+        }
+        result["id"] = id;
+        channel->send(result);
+    });
+}
+
+void serveStdio(JobQueue &queue, unsigned job_threads) {
+    // The solvers log to std::cout, which must not interleave with the
+    // results. Keep the original stdout for the results and redirect the
+    // log to stderr.
+    const auto result_fd = ::dup(STDOUT_FILENO);
+    std::cout.flush();
+    ::dup2(STDERR_FILENO, STDOUT_FILENO);
+    auto channel = std::make_shared<ResultChannel>(result_fd);
+    std::string line;
+    while (!shutdown_requested && std::getline(std::cin, line)) {
+        dispatch(line, channel, queue, job_threads);
+    }
+    queue.close();
+}
+
+void serveClient(int fd, JobQueue &queue, unsigned job_threads) {
+    cetsp::details::LineConnection connection(fd);
+    auto channel = std::make_shared<ResultChannel>(::dup(fd));
+    while (!shutdown_requested && !connection.is_closed()) {
+        auto line = connection.receive(100);
+        if (line) {
+            dispatch(*line, channel, queue, job_threads);
+        }
+    }
+}
+
+void serveSocket(const std::string &address, JobQueue &queue, unsigned job_threads) {
+    const auto listen_fd = cetsp::details::listen_on(address);
+    std::cerr << "Listening on " << address << std::endl;
+    boost::thread_group clients;
+    while (!shutdown_requested) {
+        pollfd pfd{listen_fd, POLLIN, 0};
+        if (::poll(&pfd, 1, 100) <= 0 || !(pfd.revents & POLLIN)) {
+            continue;
+        }
+        const auto fd = ::accept(listen_fd, nullptr, nullptr);
+        if (fd >= 0) {
+            clients.create_thread([fd, &queue, job_threads]() { serveClient(fd, queue, job_threads); });
+        }
+    }
+    ::close(listen_fd);
+    queue.close();
+    clients.join_all();
+}
+
+int main(int argc, char *argv[]) {
+    ::signal(SIGPIPE, SIG_IGN); // clients may disconnect before their results are sent
+    std::string address;
+    const auto hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned num_workers = std::max(1u, hardware_threads / 4);
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind("unix:", 0) == 0) {
+            address = arg;
+        } else {
+            num_workers = std::max(1, std::stoi(arg));
+        }
+    }
+    // The workers share the hardware threads.
+    const auto job_threads = std::max(1u, hardware_threads / num_workers);
+    JobQueue queue(num_workers);
+    if (address.empty()) {
+        serveStdio(queue, job_threads);
+    } else {
+        serveSocket(address, queue, job_threads);
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+"""
+Client for the `solver_daemon` binary. Jobs are submitted asynchronously and
+return futures, so multiple jobs can run concurrently in the daemon.
+
+    with DaemonClient("unix:/tmp/mowing.sock") as client:
+        future = client.lower_bound("instance.poly", radius=1, time=60, ...)
+        result = future.result()
+
+Without an address, the client starts its own daemon and talks to it via
+stdin/stdout, which serves as a local stand-in for a shared daemon.
+"""
+import itertools
+import json
+import socket
+import subprocess
+import threading
+from concurrent.futures import Future
+
+
+class DaemonError(RuntimeError):
+    pass
+
+
+class DaemonClient:
+    def __init__(self, address=None, binary="solver_daemon", num_workers=None):
+        self._futures = {}
+        self._ids = itertools.count()
+        self._lock = threading.Lock()
+        self._process = None
+        if address is None:
+            args = [binary] + ([str(num_workers)] if num_workers else [])
+            self._process = subprocess.Popen(args, stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+            self._writer = self._process.stdin
+            self._reader = self._process.stdout
+        else:
+            if not address.startswith("unix:"):
+                raise ValueError(f"Unsupported address {address}")
+            self._socket = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+            self._socket.connect(address[len("unix:"):])
+            self._writer = self._socket.makefile("wb")
+            self._reader = self._socket.makefile("rb")
+        self._receiver = threading.Thread(target=self._receive, daemon=True)
+        self._receiver.start()
+
+    def submit(self, job: dict) -> Future:
+        """
+        Submits a job (see solver_daemon.cpp for the format) and returns a future
+        for the result. Failed jobs raise a DaemonError.
+        """
+        future = Future()
+        with self._lock:
+            job_id = next(self._ids)
+            self._futures[job_id] = future
+            self._writer.write((json.dumps(dict(job, id=job_id)) + "\n").encode())
+            self._writer.flush()
+        return future
+
+    def ping(self) -> Future:
+        return self.submit({"type": "ping"})
+
+    def cetsp(self, points, radius, time, start=None) -> Future:
+        job = {"type": "cetsp", "points": [list(p) for p in points], "radius": radius, "time": time}
+        if start is not None:
+            job["start"] = list(start)
+        return self.submit(job)
+
+    def lower_bound(self, polygon_file, radius, time, initial_strategy, followup_strategy,
+                    max_initial_witnesses, max_witnesses, max_iterations) -> Future:
+        return self.submit({"type": "lower_bound",
+                            "polygon_file": polygon_file,
+                            "radius": radius,
+                            "time": time,
+                            "initial_strategy": initial_strategy,
+                            "followup_strategy": followup_strategy,
+                            "max_witness_size_initial": max_initial_witnesses,
+                            "max_witness_size": max_witnesses,
+                            "max_iterations": max_iterations})
+
+    def shutdown(self):
+        """
+        Stops the daemon after its running jobs are finished.
+        """
+        with self._lock:
+            self._writer.write(b'{"type": "shutdown"}\n')
+            self._writer.flush()
+
+    def close(self):
+        if self._process is not None:
+            self.shutdown()
+            self._writer.close()
+            self._process.wait()
+        else:
+            self._socket.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        self.close()
+
+    def _receive(self):
+        for line in self._reader:
+            result = json.loads(line)
+            with self._lock:
+                future = self._futures.pop(result.get("id"), None)
+            if future is None:
+                continue  # e.g. a malformed job without id
+            if "error" in result:
+                future.set_exception(DaemonError(result["error"]))
+            else:
+                future.set_result(result)
+        # The connection is closed, no further results will arrive.
+        with self._lock:
+            futures, self._futures = self._futures, {}
+        for future in futures.values():
+            future.set_exception(DaemonError("Connection to the daemon closed."))
@@ -7,6 +7,7 @@
 #ifndef CETSP_BNB_H
 #define CETSP_BNB_H
 #include "cetsp/callbacks.h"
+#include "cetsp/details/profiling.h"
 #include "cetsp/details/solution_pool.h"
 #include "cetsp/strategies/branching_strategy.h"
 #include "cetsp/strategies/root_node_strategy.h"
@@ -21,13 +22,21 @@ class BranchAndBoundAlgorithm {
    * Implements the branch and bound algorithm.
    */
 public:
+  /**
+   * @param solution_pool Optionally, a solution pool shared with other
+   * BnB-algorithms on the same instance, e.g., in a portfolio. By default,
+   * an own pool is used.
+   */
   BranchAndBoundAlgorithm(Instance *instance, std::shared_ptr<Node> root_,
                           BranchingStrategy &branching_strategy,
-                          SearchStrategy &search_strategy)
+                          SearchStrategy &search_strategy,
+                          std::shared_ptr<SolutionPool> solution_pool_ = nullptr)
       : instance{instance}, root{std::move(root_)},
         search_strategy{search_strategy},
-        branching_strategy(branching_strategy) {
-    branching_strategy.setup(instance, root, &solution_pool);
+        branching_strategy(branching_strategy),
+        solution_pool{solution_pool_ ? std::move(solution_pool_)
+                                     : std::make_shared<SolutionPool>()} {
+    branching_strategy.setup(instance, root, solution_pool.get());
     search_strategy.init(root);
   }
 
@@ -44,7 +53,7 @@ public:
    * @param solution The feasible solution.
    */
   void add_upper_bound(const Solution &solution) {
-    solution_pool.add_solution(solution);
+    solution_pool->add_solution(solution);
   }
 
   /**
@@ -59,7 +68,7 @@ public:
   /**
    * Returns the current best known upper bound.
    */
-  double get_upper_bound() { return solution_pool.get_upper_bound(); }
+  double get_upper_bound() { return solution_pool->get_upper_bound(); }
   /**
    * Returns the current best known lower bound.
    * @return
@@ -71,9 +80,15 @@ public:
    * @return A feasible solution trajectory.
    */
   std::unique_ptr<Solution> get_solution() {
-    return solution_pool.get_best_solution();
+    return solution_pool->get_best_solution();
   }
 
+  /**
+   * Stops a running `optimize` after the current iteration. Can be called
+   * from a different thread.
+   */
+  void stop() { stop_requested = true; }
+
   /**
    * Run the Branch and Bound algorithm.
    * @param timelimit_s The timelimit in seconds, after which it aborts.
@@ -81,11 +96,15 @@ public:
    * @param verbose Defines if you want to see a progress log.
    */
   void optimize(int timelimit_s, double gap = 0.01, bool verbose = true) {
+    details::Profiler::Activation profiling(&profiler);
     print_start_stats(verbose);
     utils::Timer timer(timelimit_s);
-    while (search_strategy.has_next()) {
-      auto next = search_strategy.next();
+    while (has_next_node()) {
+      auto next = next_node();
       visit_node(next, gap);
+      if (branching_strategy.requires_restart()) {
+        restart_from_root(verbose);
+      }
       auto lb = get_lower_bound();
       auto ub = get_upper_bound();
       print_iteration_stats(verbose, lb, ub, timer.seconds());
@@ -97,7 +116,12 @@ public:
         print_timeout(verbose);
         break;
       }
+      if (stop_requested) {
+        break;
+      }
     }
+    notify_termination();
+    runtime_s += timer.seconds();
     print_final_stats(verbose);
   }
 
@@ -106,10 +130,36 @@ public:
     stats["num_iterations"] = std::to_string(num_iterations);
     stats["num_branches"] = std::to_string(num_branches);
     stats["num_explored"] = std::to_string(num_explored);
+    stats["nodes_per_second"] = std::to_string(
+        runtime_s > 0 ? static_cast<double>(num_explored) / runtime_s : 0.0);
+    stats["peak_open_nodes"] = std::to_string(peak_open_nodes);
+    stats["num_restarts"] = std::to_string(num_restarts);
+#ifdef CETSP_PROFILING
+    profiler.add_statistics(stats);
+#endif
     return stats;
   }
 
 private:
+  bool has_next_node() {
+    CETSP_PROFILE_SCOPE(SEARCH);
+    return search_strategy.has_next();
+  }
+
+  std::shared_ptr<Node> next_node() {
+    CETSP_PROFILE_SCOPE(SEARCH);
+    return search_strategy.next();
+  }
+
+  void notify_termination() {
+    CETSP_PROFILE_SCOPE(CALLBACKS);
+    EventContext context{root, root, instance, solution_pool.get(),
+                         num_iterations};
+    for (auto &callback : node_callbacks) {
+      callback->on_termination(context);
+    }
+  }
+
   void print_timeout(bool verbose) const {
     if (verbose) {
       std::cout << "Timeout." << std::endl;
@@ -160,7 +210,7 @@ private:
   bool prune_if_above_ub(std::shared_ptr<Node> &node, const double gap) {
     if (node->is_pruned() ||
         node->get_lower_bound() >=
-            (1.0 - gap) * solution_pool.get_upper_bound()) {
+            (1.0 - gap) * solution_pool->get_upper_bound()) {
       node->prune(false);
       on_prune(*node);
       return true;
@@ -180,13 +230,18 @@ private:
     }
     // Explore  node.
     num_explored += 1;
-    EventContext context{node, root, instance, &solution_pool, num_iterations};
-    for (auto &callback : node_callbacks) {
-      callback->on_entering_node(context);
+    EventContext context{node, root, instance, solution_pool.get(),
+                         num_iterations};
+    {
+      CETSP_PROFILE_SCOPE(CALLBACKS);
+      for (auto &callback : node_callbacks) {
+        callback->on_entering_node(context);
+      }
     }
     if (!node->is_pruned()) { // the user callback may have pruned the node
       explore_node(node, context, gap);
     }
+    CETSP_PROFILE_SCOPE(CALLBACKS);
     for (auto &callback : node_callbacks) {
       callback->on_leaving_node(context);
     }
@@ -216,6 +271,7 @@ private:
     if (node->is_feasible()) {
       // If node is feasible, check lazy constraints (the user may decide
       // to add further circles, making it infeasible again).
+      CETSP_PROFILE_SCOPE(CALLBACKS);
       for (auto &callback : node_callbacks) {
         callback->add_lazy_constraints(context);
         if (!node->is_feasible()) {
@@ -230,15 +286,40 @@ private:
   void branch_node(std::shared_ptr<Node> &node) {
     if (branching_strategy.branch(*node)) {
       num_branches += 1;
+      CETSP_PROFILE_SCOPE(SEARCH);
       search_strategy.notify_of_branch(*node);
+      peak_open_nodes =
+          std::max(peak_open_nodes, search_strategy.get_num_open_nodes());
     }
   }
 
-  void on_prune(Node &node) { search_strategy.notify_of_prune(node); }
+  /**
+   * Replaces the tree by a fresh root with the same sequence. The open nodes
+   * of the old tree are pruned and dropped by the search when they come up.
+   * The old tree is kept until then, as they still refer to their parents.
+   */
+  void restart_from_root(bool verbose) {
+    if (verbose) {
+      std::cout << "Restarting from the root." << std::endl;
+    }
+    ++num_restarts;
+    const auto sequence = root->get_fixed_sequence();
+    root->prune(false);
+    discarded_roots.push_back(root);
+    root = std::make_shared<Node>(sequence, instance);
+    CETSP_PROFILE_SCOPE(SEARCH);
+    search_strategy.init(root);
+  }
+
+  void on_prune(Node &node) {
+    CETSP_PROFILE_SCOPE(SEARCH);
+    search_strategy.notify_of_prune(node);
+  }
 
   void process_feasible_node(std::shared_ptr<Node> &node,
                              EventContext &context) {
-    solution_pool.add_solution(node->get_relaxed_solution());
+    solution_pool->add_solution(node->get_relaxed_solution());
+    CETSP_PROFILE_SCOPE(SEARCH);
     search_strategy.notify_of_feasible(*(context.current_node));
   }
 
@@ -249,10 +330,17 @@ private:
       node_callbacks;                    // Allows to modify the BnB-behavior.
   BranchingStrategy &branching_strategy; // decides how to branch on a node, if
                                          // it is not yet feasible.
-  SolutionPool solution_pool;            // Saves all solutions found so far.
-  int num_iterations = 0;                // how many nodes have been looked at
+  std::shared_ptr<SolutionPool>
+      solution_pool;      // Saves all solutions found so far (maybe shared).
+  std::atomic<bool> stop_requested{false}; // set by `stop`.
+  int num_iterations = 0; // how many nodes have been looked at
   int num_explored = 0;                  // how many nodes have been explored
   int num_branches = 0; // how many of those nodes have been branched upon
+  size_t peak_open_nodes = 0; // maximal number of open nodes after a branch
+  int num_restarts = 0;       // see `restart_from_root`
+  std::vector<std::shared_ptr<Node>> discarded_roots; // see `restart_from_root`
+  double runtime_s = 0.0;     // time spent in `optimize`
+  details::Profiler profiler; // the phases of this BnB, see `optimize`
 };
 
 
@@ -102,6 +102,13 @@ public:
      * what happened to the node (pruned/branched/feasible).
      */
   }
+  virtual void on_termination(EventContext &) {
+    /**
+     * Called once at the end of every `optimize`, with the root as current
+     * node. This is the place to stop background work of the callback, as
+     * no further node will be entered until the next `optimize`.
+     */
+  }
 };
 };     // namespace cetsp
 #endif // CETSP_CALLBACKS_H
@@ -6,6 +6,7 @@
 #ifndef CLOSE_ENOUGH_TSP_COMMON_H
 #define CLOSE_ENOUGH_TSP_COMMON_H
 #include "details/cgal_kernel.h"
+#include "details/hilbert_curve.h"
 #include "utils/geometry.h"
 #include <CGAL/squared_distance_2.h> //for 2D functions
 #include <cmath>
@@ -95,13 +96,88 @@ public:
       return;
     }
     push_back(circle);
+    if (!original_indices.empty()) {
+      original_indices.push_back(static_cast<int>(size()) - 1);
+    }
     revision += 1;
   }
 
+  /**
+   * Renumbers the circles along a Hilbert curve through their centers, such
+   * that circles close in space are also close in memory. This improves the
+   * cache behavior of all the scans over the circles. Has to be called before
+   * solving, as all sequences refer to the indices. Use `original_index` to
+   * translate indices back.
+   */
+  void reorder_along_hilbert_curve() {
+    constexpr unsigned ORDER = 16;
+    if (empty()) {
+      return;
+    }
+    double min_x = front().center.x, max_x = min_x;
+    double min_y = front().center.y, max_y = min_y;
+    for (const auto &circle : *this) {
+      min_x = std::min(min_x, circle.center.x);
+      max_x = std::max(max_x, circle.center.x);
+      min_y = std::min(min_y, circle.center.y);
+      max_y = std::max(max_y, circle.center.y);
+    }
+    const double cells = (1u << ORDER) - 1;
+    const double scale =
+        cells / std::max({max_x - min_x, max_y - min_y, 1e-9});
+    std::vector<std::pair<uint64_t, int>> keys;
+    keys.reserve(size());
+    for (int i = 0; i < static_cast<int>(size()); ++i) {
+      const auto &c = (*this)[i].center;
+      const auto x = static_cast<uint32_t>((c.x - min_x) * scale);
+      const auto y = static_cast<uint32_t>((c.y - min_y) * scale);
+      keys.emplace_back(details::hilbert_index(x, y, ORDER), i);
+    }
+    std::stable_sort(keys.begin(), keys.end(), [](const auto &a, const auto &b) {
+      return a.first < b.first;
+    });
+    std::vector<Circle> reordered;
+    reordered.reserve(size());
+    std::vector<int> new_original_indices;
+    new_original_indices.reserve(size());
+    for (const auto &[key, i] : keys) {
+      reordered.push_back((*this)[i]);
+      new_original_indices.push_back(original_index(i));
+    }
+    std::copy(reordered.begin(), reordered.end(), begin());
+    original_indices = std::move(new_original_indices);
+    revision += 1; // the indices have changed
+  }
+
+  /**
+   * Returns the index the circle had before `reorder_along_hilbert_curve`.
+   */
+  [[nodiscard]] int original_index(int i) const {
+    return original_indices.empty() ? i : original_indices[i];
+  }
+
+  /**
+   * Translates a sequence back to the indices before
+   * `reorder_along_hilbert_curve`.
+   */
+  [[nodiscard]] std::vector<int>
+  to_original_indices(const std::vector<int> &sequence) const {
+    std::vector<int> original;
+    original.reserve(sequence.size());
+    for (const auto i : sequence) {
+      original.push_back(original_index(i));
+    }
+    return original;
+  }
+
   std::optional<std::pair<Point, Point>> path;
   int revision =
       0; // actually the size  should already say enough about  the revision.
   double eps = 0.01;
+
+private:
+  // Index of every circle before reordering. Empty if not reordered.
+  std::vector<int> original_indices;
 };
 
 class Trajectory {
@@ -35,6 +35,12 @@ public:
 
   std::optional<double> operator()(const Circle &circle);
 
+  /**
+   * True if the point is inside or on the convex hull, i.e., adding it would
+   * not change the hull. False for degenerated hulls.
+   */
+  [[nodiscard]] bool contains(const Point &point) const;
+
 private:
   std::vector<Segment_2>
   compute_convex_hull_segments(const std::vector<Point> &points) const;
@@ -0,0 +1,38 @@
+/**
+ * Computing the position of a grid cell on a Hilbert curve. Sorting points
+ * by this position keeps points that are close in space also close in the
+ * order, which improves the memory locality of spatial scans.
+ */
+#ifndef CETSP_HILBERT_CURVE_H
+#define CETSP_HILBERT_CURVE_H
+#include <cstdint>
+#include <utility>
+namespace cetsp::details {
+
+/**
+ * Returns the position of the cell (x, y) on the Hilbert curve through a
+ * 2^order x 2^order grid.
+ * @param x The column of the cell, in [0, 2^order).
+ * @param y The row of the cell, in [0, 2^order).
+ * @param order The order of the curve, at most 31.
+ */
+inline uint64_t hilbert_index(uint32_t x, uint32_t y, unsigned order) {
+  const uint32_t n = 1u << order;
+  uint64_t d = 0;
+  for (uint32_t s = n / 2; s > 0; s /= 2) {
+    const uint32_t rx = (x & s) > 0 ? 1 : 0;
+    const uint32_t ry = (y & s) > 0 ? 1 : 0;
+    d += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+    // rotate the quadrant such that the curve stays continuous
+    if (ry == 0) {
+      if (rx == 1) {
+        x = n - 1 - x;
+        y = n - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+} // namespace cetsp::details
+#endif // CETSP_HILBERT_CURVE_H
@@ -40,17 +40,24 @@ public:
     return true;
   }
 
+  /**
+   * Computes the trajectory with an objective cutoff, see
+   * `compute_trajectory_with_cutoff`. If the SOC is cut off, no trajectory is
+   * stored and it will be computed exactly on access.
+   * @return A certified lower bound on the length of the trajectory.
+   */
+  double trigger_computation(double cutoff) const;
+
+  [[nodiscard]] bool is_computed() const { return data.has_value(); }
+
   const Instance *instance;
   std::vector<int> sequence;
 
 private:
   void compute_trajectory() const;
 
-  void compute_tour_trajectory() const;
-
-  void compute_path_trajectory() const;
-
   mutable std::optional<std::pair<Trajectory, std::vector<bool>>> data;
 };
+
 } // namespace cetsp::details
 #endif // CETSP_LAZY_TRAJECTORY_H
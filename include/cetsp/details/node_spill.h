@@ -0,0 +1,121 @@
+/**
+ * On hard instances, the open list of the BnB can grow until it exhausts the
+ * memory. The node spill allows the search strategies to move cold open nodes
+ * to a memory-mapped file. Only the sequence and the bounds of a node are
+ * written, the trajectory is recomputed when the node is reloaded. Nodes are
+ * reloaded in best-bound order.
+ */
+#ifndef CETSP_NODE_SPILL_H
+#define CETSP_NODE_SPILL_H
+#include "../node.h"
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+namespace cetsp::details {
+
+/**
+ * Rough estimate of the memory a resident open node occupies, including its
+ * trajectory and distance cache.
+ */
+size_t estimate_memory_usage(Node &node);
+
+class NodeSpill {
+public:
+  /**
+   * @param path The file to spill to. It will be overwritten and removed on
+   * destruction.
+   */
+  explicit NodeSpill(std::string path);
+
+  /**
+   * A new file name in the temporary directory, unique within the process.
+   */
+  static std::string temporary_path();
+  NodeSpill(const NodeSpill &) = delete;
+  NodeSpill &operator=(const NodeSpill &) = delete;
+  ~NodeSpill();
+
+  /**
+   * Writes the open node to the spill file and detaches it from its parent.
+   * The node is freed as soon as the caller drops its reference.
+   * @return False if the node cannot be spilled (e.g., the root).
+   */
+  bool spill(Node &node);
+
+  /**
+   * Reloads the spilled node with the lowest lower bound and attaches it to
+   * its parent again. Nodes whose parent has been pruned in the meantime are
+   * dropped and released from their parent.
+   * @return The reloaded node or nullptr if no node is left.
+   */
+  std::shared_ptr<Node> reload();
+
+  [[nodiscard]] bool empty() const { return index.empty(); }
+
+  [[nodiscard]] size_t size() const { return index.size(); }
+
+  /**
+   * The lowest lower bound of all spilled nodes.
+   */
+  [[nodiscard]] double get_lower_bound() const {
+    return index.empty() ? std::numeric_limits<double>::infinity()
+                         : index.top().lower_bound;
+  }
+
+private:
+  struct RecordHeader {
+    double lower_bound;
+    uint64_t parent_id; // see `parents`
+    uint64_t parent_slot;
+    uint32_t sequence_length;
+    uint32_t padding;
+  };
+
+  struct IndexEntry {
+    double lower_bound;
+    double obj;
+    size_t offset;
+    // reversed to obtain a min-heap in std::priority_queue
+    bool operator<(const IndexEntry &other) const {
+      if (lower_bound == other.lower_bound) {
+        return obj > other.obj;
+      }
+      return lower_bound > other.lower_bound;
+    }
+  };
+
+  /**
+   * A parent of spilled nodes. The parents are owned by the tree, the file
+   * only refers to them by id. The raw pointer stays valid: A parent has
+   * already been branched, so it is never queued, spilled, or branched again,
+   * and it is owned by the children of its own parent up to the root. The
+   * root is held by the BranchAndBoundAlgorithm, also after a restart (see
+   * `restart_from_root`). Thus, the spill must not be reloaded after the
+   * algorithm owning the tree has been destroyed.
+   */
+  struct SpilledParent {
+    Node *node;
+    size_t num_spilled_children;
+  };
+
+  void reserve(size_t bytes);
+
+  uint64_t get_parent_id(Node *parent);
+
+  Node *release_parent_id(uint64_t id);
+
+  std::string path;
+  int fd = -1;
+  char *mapping = nullptr;
+  size_t capacity = 0;
+  size_t end = 0; // Records are appended, space is reused once empty.
+  std::priority_queue<IndexEntry> index;
+  std::unordered_map<uint64_t, SpilledParent> parents;
+  std::unordered_map<const Node *, uint64_t> parent_ids;
+  uint64_t next_parent_id = 0;
+};
+} // namespace cetsp::details
+#endif // CETSP_NODE_SPILL_H
@@ -0,0 +1,204 @@
+/**
+ * Lightweight per-phase profiling of the BnB. Every BnB-algorithm has its
+ * own counters, such that concurrent ones (e.g., in a portfolio) do not mix
+ * their numbers. The counters are only collected if the library is compiled
+ * with `CETSP_PROFILING` (CMake option of the same name). Otherwise,
+ * `CETSP_PROFILE_SCOPE` expands to nothing and there is no overhead.
+ */
+#ifndef CETSP_PROFILING_H
+#define CETSP_PROFILING_H
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <time.h>
+#include <unordered_map>
+
+namespace cetsp::details {
+
+enum class ProfilingPhase {
+  SOC,         // solving the second order cone programs
+  FEASIBILITY, // distance and feasibility checks of relaxed solutions
+  RULES,       // evaluating the branching rules
+  SEARCH,      // operations of the search strategy
+  CALLBACKS,   // user callbacks
+  THREAD_IDLE, // worker threads waiting for the slowest thread
+  NUM_PHASES
+};
+
+inline const char *to_string(ProfilingPhase phase) {
+  static const std::array<const char *,
+                          static_cast<size_t>(ProfilingPhase::NUM_PHASES)>
+      names = {"soc",    "feasibility", "rules",
+               "search", "callbacks",   "thread_idle"};
+  return names[static_cast<size_t>(phase)];
+}
+
+inline uint64_t profiling_clock_ns(clockid_t clock) {
+  timespec ts{};
+  clock_gettime(clock, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull +
+         static_cast<uint64_t>(ts.tv_nsec);
+}
+
+class Profiler {
+public:
+  Profiler() = default;
+  Profiler(const Profiler &) = delete;
+  Profiler &operator=(const Profiler &) = delete;
+
+  /**
+   * The profiler the scopes of the current thread record to, e.g., of the
+   * BnB-algorithm running on it. Nothing is recorded if there is none.
+   */
+  static Profiler *&current() {
+    thread_local Profiler *profiler = nullptr;
+    return profiler;
+  }
+
+  /**
+   * Makes a profiler the current one of this thread until the end of the
+   * scope. Worker threads have to activate the profiler of their caller.
+   */
+  class Activation {
+  public:
+    explicit Activation(Profiler *profiler) : previous{current()} {
+      current() = profiler;
+    }
+    Activation(const Activation &) = delete;
+    Activation &operator=(const Activation &) = delete;
+    ~Activation() { current() = previous; }
+
+  private:
+    Profiler *previous;
+  };
+
+  void record(ProfilingPhase phase, uint64_t wall_ns, uint64_t cpu_ns) {
+    const auto i = static_cast<size_t>(phase);
+    count[i].fetch_add(1, std::memory_order_relaxed);
+    this->wall_ns[i].fetch_add(wall_ns, std::memory_order_relaxed);
+    this->cpu_ns[i].fetch_add(cpu_ns, std::memory_order_relaxed);
+    if (phase == ProfilingPhase::SOC) { // for the percentiles
+      soc_histogram[histogram_bucket(wall_ns)].fetch_add(
+          1, std::memory_order_relaxed);
+    }
+  }
+
+  void reset() {
+    for (size_t i = 0; i < count.size(); ++i) {
+      count[i] = 0;
+      wall_ns[i] = 0;
+      cpu_ns[i] = 0;
+    }
+    for (auto &bucket : soc_histogram) {
+      bucket = 0;
+    }
+  }
+
+  /**
+   * Adds the counters to the statistics as
+   * `profile_<phase>_{count,wall_s,cpu_s}`, plus the mean and p99 of the
+   * SOC wall times in milliseconds. The p99 is the upper end of its
+   * histogram bucket, i.e., it overestimates by at most 19%.
+   */
+  void add_statistics(std::unordered_map<std::string, std::string> &stats) const {
+    for (size_t i = 0; i < count.size(); ++i) {
+      const std::string prefix =
+          std::string("profile_") + to_string(static_cast<ProfilingPhase>(i));
+      stats[prefix + "_count"] = std::to_string(count[i].load());
+      stats[prefix + "_wall_s"] =
+          std::to_string(static_cast<double>(wall_ns[i].load()) / 1e9);
+      stats[prefix + "_cpu_s"] =
+          std::to_string(static_cast<double>(cpu_ns[i].load()) / 1e9);
+    }
+    const auto soc = static_cast<size_t>(ProfilingPhase::SOC);
+    uint64_t num_samples = 0;
+    for (const auto &bucket : soc_histogram) {
+      num_samples += bucket.load();
+    }
+    if (num_samples == 0) {
+      return;
+    }
+    stats["profile_soc_mean_ms"] =
+        std::to_string(static_cast<double>(wall_ns[soc].load()) /
+                       static_cast<double>(num_samples) / 1e6);
+    const auto rank = (num_samples - 1) * 99 / 100;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < soc_histogram.size(); ++b) {
+      seen += soc_histogram[b].load();
+      if (seen > rank) {
+        stats["profile_soc_p99_ms"] =
+            std::to_string(bucket_upper_bound_ns(b) / 1e6);
+        break;
+      }
+    }
+  }
+
+private:
+  // Logarithmic buckets with four buckets per power of two, covering all
+  // 64-bit nanoseconds.
+  static constexpr size_t BUCKETS_PER_OCTAVE = 4;
+  static constexpr size_t NUM_BUCKETS = 64 * BUCKETS_PER_OCTAVE;
+
+  static size_t histogram_bucket(uint64_t ns) {
+    if (ns == 0) {
+      return 0;
+    }
+    const auto bucket = static_cast<size_t>(
+        std::log2(static_cast<double>(ns)) * BUCKETS_PER_OCTAVE);
+    return std::min(bucket, NUM_BUCKETS - 1);
+  }
+
+  static double bucket_upper_bound_ns(size_t bucket) {
+    return std::exp2(static_cast<double>(bucket + 1) / BUCKETS_PER_OCTAVE);
+  }
+
+  std::array<std::atomic<uint64_t>,
+             static_cast<size_t>(ProfilingPhase::NUM_PHASES)>
+      count{};
+  std::array<std::atomic<uint64_t>,
+             static_cast<size_t>(ProfilingPhase::NUM_PHASES)>
+      wall_ns{};
+  std::array<std::atomic<uint64_t>,
+             static_cast<size_t>(ProfilingPhase::NUM_PHASES)>
+      cpu_ns{};
+  std::array<std::atomic<uint64_t>, NUM_BUCKETS> soc_histogram{};
+};
+
+/**
+ * Measures the wall and CPU time of the current thread until the end of the
+ * scope. Use via `CETSP_PROFILE_SCOPE`.
+ */
+class ProfilingScope {
+public:
+  explicit ProfilingScope(ProfilingPhase phase)
+      : phase{phase}, wall_start{profiling_clock_ns(CLOCK_MONOTONIC)},
+        cpu_start{profiling_clock_ns(CLOCK_THREAD_CPUTIME_ID)} {}
+  ProfilingScope(const ProfilingScope &) = delete;
+  ProfilingScope &operator=(const ProfilingScope &) = delete;
+  ~ProfilingScope() {
+    if (auto *profiler = Profiler::current()) {
+      profiler->record(
+          phase, profiling_clock_ns(CLOCK_MONOTONIC) - wall_start,
+          profiling_clock_ns(CLOCK_THREAD_CPUTIME_ID) - cpu_start);
+    }
+  }
+
+private:
+  ProfilingPhase phase;
+  uint64_t wall_start;
+  uint64_t cpu_start;
+};
+} // namespace cetsp::details
+
+#ifdef CETSP_PROFILING
+#define CETSP_PROFILE_SCOPE(phase)                                            \
+  ::cetsp::details::ProfilingScope cetsp_profiling_scope(                     \
+      ::cetsp::details::ProfilingPhase::phase)
+#else
+#define CETSP_PROFILE_SCOPE(phase)
+#endif
+
+#endif // CETSP_PROFILING_H
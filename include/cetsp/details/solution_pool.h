@@ -9,20 +9,31 @@
 
 #include "../common.h"
 #include "../relaxed_solution.h"
+#include <atomic>
+#include <mutex>
 
 namespace cetsp {
+/**
+ * The solution pool is thread-safe, such that it can be shared by multiple
+ * BnB-algorithms running in parallel (e.g., in a portfolio). The upper bound
+ * can be read without locking.
+ */
 class SolutionPool {
 public:
   void add_solution(const Solution &solution) {
     auto solution_length = solution.get_trajectory().length();
     if (solution_length < ub) {
-      solutions.push_back(solution);
-      ub = solution_length;
+      std::lock_guard<std::mutex> lock(mutex);
+      if (solution_length < ub) { // may have changed in the meantime
+        solutions.push_back(solution);
+        ub = solution_length;
+      }
     }
   }
-  double get_upper_bound() { return ub; }
+  double get_upper_bound() const { return ub; }
 
   std::unique_ptr<Solution> get_best_solution() {
+    std::lock_guard<std::mutex> lock(mutex);
     if (solutions.empty()) {
       return nullptr;
     }
@@ -30,10 +41,14 @@ public:
         solutions.back()); // best solution is always at the end
   }
 
-  bool empty() { return solutions.empty(); }
+  bool empty() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return solutions.empty();
+  }
 
 private:
-  double ub = std::numeric_limits<double>::infinity();
+  std::atomic<double> ub{std::numeric_limits<double>::infinity()};
+  std::mutex mutex;
   std::vector<Solution> solutions;
 };
 } // namespace cetsp
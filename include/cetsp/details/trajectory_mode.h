@@ -0,0 +1,36 @@
+/**
+ * Compile-time policies for tours and paths. Code that depends on the mode
+ * in inner loops is templated on the policy and dispatched only once with
+ * `with_trajectory_mode`, such that the loops compile without mode branches.
+ */
+#ifndef CETSP_TRAJECTORY_MODE_H
+#define CETSP_TRAJECTORY_MODE_H
+#include "cetsp/common.h"
+namespace cetsp::details {
+
+/**
+ * The trajectory returns to its first point.
+ */
+struct TourMode {
+  static constexpr bool is_path = false;
+};
+
+/**
+ * The trajectory starts and ends at the fixed endpoints of the instance.
+ */
+struct PathMode {
+  static constexpr bool is_path = true;
+};
+
+/**
+ * Calls `f` with the policy (`TourMode` or `PathMode`) of the instance.
+ */
+template <typename F>
+decltype(auto) with_trajectory_mode(const Instance &instance, F &&f) {
+  if (instance.is_path()) {
+    return f(PathMode{});
+  }
+  return f(TourMode{});
+}
+} // namespace cetsp::details
+#endif // CETSP_TRAJECTORY_MODE_H
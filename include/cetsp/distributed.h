@@ -0,0 +1,211 @@
+/**
+ * Distributed BnB over TCP or Unix sockets. The BnB tree is naturally
+ * partitionable by subtrees: A coordinator expands the top of the tree into
+ * a frontier of open nodes and hands them out as subproblems (fixed sequence
+ * and lower bound) to worker processes, which can run on the same or other
+ * hosts. The workers explore the subproblems with a local
+ * BranchAndBoundAlgorithm and stream new solutions and bound updates back.
+ * The coordinator broadcasts every improved solution to all workers.
+ *
+ * Addresses are given as `unix:<path>` or `tcp:<host>:<port>`.
+ *
+ * Protocol (one message per line, all numbers in full precision):
+ *  coordinator -> worker:
+ *    INSTANCE <n> <x_1> <y_1> <r_1> ... <x_n> <y_n> <r_n>
+ *    SUB <id> <lb> <k> <i_1> ... <i_k>   subproblem with fixed sequence
+ *    UB <k> <i_1> ... <i_k>              new incumbent as sequence
+ *    STOP
+ *  worker -> coordinator:
+ *    READY                               request a subproblem
+ *    SOL <k> <i_1> ... <i_k>             new incumbent as sequence
+ *    LB <id> <lb>                        improved lower bound of subproblem
+ *    DONE <id> <lb>                      subproblem explored, final bound
+ *
+ * Only tours are supported, and the instance must not change (no lazy
+ * constraints).
+ */
+#ifndef CETSP_DISTRIBUTED_H
+#define CETSP_DISTRIBUTED_H
+#include "cetsp/bnb.h"
+#include <functional>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+namespace cetsp {
+
+namespace details {
+/**
+ * A socket connection exchanging newline-terminated text messages.
+ */
+class LineConnection {
+public:
+  explicit LineConnection(int fd) : fd{fd} {}
+  LineConnection(const LineConnection &) = delete;
+  LineConnection &operator=(const LineConnection &) = delete;
+  ~LineConnection();
+
+  /**
+   * Sends a message. A newline is appended. Failures mark the connection as
+   * closed.
+   */
+  void send(const std::string &line);
+
+  /**
+   * Returns the next message, waiting at most `timeout_ms` milliseconds
+   * (negative to wait forever). Returns nothing on timeout or if the
+   * connection has been closed, see `is_closed`.
+   */
+  std::optional<std::string> receive(int timeout_ms);
+
+  [[nodiscard]] bool is_closed() const { return closed; }
+
+  /**
+   * Closes the connection, e.g., after a protocol violation. The file
+   * descriptor stays valid until destruction.
+   */
+  void close();
+
+  [[nodiscard]] int get_fd() const { return fd; }
+
+private:
+  std::optional<std::string> pop_line();
+
+  int fd;
+  std::string buffer;
+  bool closed = false;
+};
+
+/**
+ * Opens a listening socket on the address (`unix:<path>` or
+ * `tcp:<host>:<port>`).
+ */
+int listen_on(const std::string &address);
+
+/**
+ * Connects to the address. Retries for a few seconds, such that workers
+ * can be started before the coordinator listens.
+ */
+int connect_to(const std::string &address);
+} // namespace details
+
+class DistributedCoordinator {
+public:
+  /**
+   * @param instance The instance to solve.
+   * @param root The root node, e.g., from a RootNodeStrategy.
+   * @param branching_strategy Used to expand the frontier. The workers
+   * should use an equivalent strategy (including the rules).
+   * @param address The address to listen on.
+   */
+  DistributedCoordinator(Instance *instance, std::shared_ptr<Node> root,
+                         BranchingStrategy &branching_strategy,
+                         std::string address);
+
+  /**
+   * Add a feasible solution as upper bound. It is sent to the workers.
+   */
+  void add_upper_bound(const Solution &solution) {
+    solution_pool.add_solution(solution);
+  }
+
+  /**
+   * Expands the frontier and distributes it to the connecting workers until
+   * the gap is proven, the tree is explored, or the time limit is reached.
+   * Afterwards, all workers are stopped.
+   * @param timelimit_s The timelimit in seconds.
+   * @param gap Allowed optimality gap.
+   * @param frontier_size Number of subproblems to create.
+   * @param verbose Print the progress.
+   */
+  void optimize(int timelimit_s, double gap = 0.01, size_t frontier_size = 64,
+                bool verbose = true);
+
+  double get_upper_bound() const { return solution_pool.get_upper_bound(); }
+
+  /**
+   * The minimum of the bounds of all open and explored subproblems.
+   */
+  double get_lower_bound() const;
+
+  std::unique_ptr<Solution> get_solution() {
+    return solution_pool.get_best_solution();
+  }
+
+  std::unordered_map<std::string, std::string> get_statistics() const;
+
+private:
+  struct Subproblem {
+    std::vector<int> sequence;
+    double lower_bound;
+    size_t worker = 0; // only valid for assigned subproblems
+  };
+
+  void expand_frontier(size_t frontier_size, double gap);
+  void accept_worker(int listen_fd);
+  /**
+   * Handles a message of a worker.
+   * @return False if the message is unknown.
+   * @throws std::invalid_argument If the message is malformed.
+   */
+  bool handle_message(size_t worker, const std::string &line);
+  /**
+   * Sends the most promising pending subproblem to the worker. If there is
+   * none, the worker is idle until a subproblem is requeued.
+   */
+  void assign_subproblem(size_t worker);
+  void assign_to_idle_workers();
+  /**
+   * Moves the subproblems of a lost worker back to the pending ones and
+   * hands them to idle workers.
+   */
+  void requeue_subproblems_of(size_t worker);
+  void drop_worker(size_t worker);
+  void broadcast_upper_bound();
+
+  Instance *instance;
+  std::shared_ptr<Node> root;
+  BranchingStrategy &branching_strategy;
+  std::string address;
+  SolutionPool solution_pool;
+  std::vector<Subproblem> pending;
+  std::unordered_map<int, Subproblem> assigned;
+  double explored_lower_bound = std::numeric_limits<double>::infinity();
+  std::vector<std::unique_ptr<details::LineConnection>> workers;
+  std::set<size_t> idle_workers; // sent READY, but nothing was pending
+  int next_subproblem_id = 0;
+  int num_workers_connected = 0;
+  int num_subproblems_solved = 0;
+  int num_solutions_received = 0;
+};
+
+class DistributedWorker {
+public:
+  /**
+   * Creates the strategies for a subproblem. Called once per subproblem, as
+   * the strategies keep state.
+   */
+  using StrategyFactory = std::function<std::pair<
+      std::unique_ptr<BranchingStrategy>, std::unique_ptr<SearchStrategy>>()>;
+
+  DistributedWorker(std::string address, StrategyFactory strategy_factory)
+      : address{std::move(address)},
+        strategy_factory{std::move(strategy_factory)} {}
+
+  /**
+   * Connects to the coordinator and explores subproblems until the
+   * coordinator sends STOP or closes the connection.
+   * @param timelimit_s Time limit for the whole run.
+   * @param gap Allowed optimality gap, should be the one of the coordinator.
+   * @param verbose Print the progress of the local BnB.
+   * @return The number of explored subproblems.
+   */
+  int run(int timelimit_s, double gap = 0.01, bool verbose = false);
+
+private:
+  std::string address;
+  StrategyFactory strategy_factory;
+};
+} // namespace cetsp
+#endif // CETSP_DISTRIBUTED_H
@@ -0,0 +1,93 @@
+/**
+ * A diving heuristic as callback for the BnB. Incumbents are otherwise only
+ * found if a node happens to be feasible, which can take many nodes, e.g.,
+ * with CheapestBreadthFirst. The dive starts at the sequence of the current
+ * node and repeatedly inserts the farthest uncovered circle at its cheapest
+ * position, until the sequence is feasible.
+ *
+ * The dive runs on a spare thread on a copy of the instance, such that the
+ * search is not blocked. Its result is added to the solution pool at the
+ * next node, after checking it against the (possibly extended) instance.
+ * A running dive is aborted at the end of `optimize`.
+ */
+#ifndef CETSP_DIVING_HEURISTIC_H
+#define CETSP_DIVING_HEURISTIC_H
+#include "cetsp/callbacks.h"
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+namespace cetsp {
+
+class DivingHeuristicCallback : public B2BNodeCallback {
+public:
+  /**
+   * @param interval Dive every `interval` nodes.
+   * @param stagnation_interval If the upper bound has not improved for this
+   * many nodes, dive every `stagnation_interval` nodes instead.
+   */
+  explicit DivingHeuristicCallback(int interval = 1000,
+                                   int stagnation_interval = 100)
+      : interval{interval}, stagnation_interval{stagnation_interval} {}
+
+  DivingHeuristicCallback(const DivingHeuristicCallback &) = delete;
+  DivingHeuristicCallback &operator=(const DivingHeuristicCallback &) = delete;
+
+  ~DivingHeuristicCallback() override;
+
+  void on_entering_node(EventContext &context) override;
+
+  /**
+   * Aborts a running dive and waits for its thread. A dive that has already
+   * finished still contributes its solution.
+   */
+  void on_termination(EventContext &context) override;
+
+  /**
+   * Completes a sequence to a feasible one by repeatedly inserting the
+   * farthest uncovered circle at the position with the smallest detour.
+   * @param instance The instance.
+   * @param sequence The sequence to start with.
+   * @param abort Stops the dive early if set.
+   * @return The trajectory of the feasible sequence, or nothing if aborted.
+   */
+  static std::optional<Solution> dive(const Instance &instance,
+                                      std::vector<int> sequence,
+                                      const std::atomic<bool> &abort);
+
+  [[nodiscard]] int get_num_dives() const { return num_dives; }
+
+  [[nodiscard]] bool is_diving() const { return running; }
+
+private:
+  bool should_dive(const EventContext &context) const;
+  void add_pending_solution(EventContext &context);
+  void start_dive(const EventContext &context);
+  void stop_dive();
+
+  /**
+   * The result of a dive, independent of the copied instance.
+   */
+  struct DiveResult {
+    std::vector<int> sequence;
+    Trajectory trajectory;
+    std::vector<bool> spanning_information;
+  };
+
+  int interval;
+  int stagnation_interval;
+  int last_dive = 0;
+  int last_improvement = 0;
+  double last_upper_bound = std::numeric_limits<double>::infinity();
+  int num_dives = 0;
+
+  std::thread worker;
+  std::atomic<bool> running{false};
+  std::atomic<bool> abort{false};
+  std::mutex result_mutex;
+  std::optional<DiveResult> result;
+};
+} // namespace cetsp
+#endif // CETSP_DIVING_HEURISTIC_H
@@ -5,6 +5,7 @@
 #ifndef CETSP_HEURISTICS_H
 #define CETSP_HEURISTICS_H
 #include "cetsp/common.h"
+#include "cetsp/relaxed_solution.h"
 namespace cetsp {
 /**
  * Compute a heuristic solution using a procedure based on 2-Opt.
@@ -13,5 +14,22 @@ namespace cetsp {
  */
 auto compute_tour_by_2opt(Instance &instance) -> Solution;
 
+/**
+ * Compute a heuristic solution for large instances by decomposition. The
+ * circles are partitioned into spatial clusters by k-means on their
+ * centers. The tour of every cluster is computed by a (time limited) BnB,
+ * in parallel. The cluster tours are opened and stitched together in the
+ * order of a tour through the cluster centroids. Finally, the trajectory is
+ * recomputed for the whole stitched sequence and circles that are no longer
+ * covered are inserted cheaply.
+ * @param instance The instance. Only tours are supported.
+ * @param cluster_size The (average) number of circles per cluster.
+ * @param time_limit_s The total time limit for the BnB of the clusters.
+ * @param num_threads The number of clusters to solve in parallel.
+ */
+auto compute_tour_by_clustering(Instance &instance, size_t cluster_size = 150,
+                                double time_limit_s = 30.0,
+                                unsigned num_threads = 1) -> Solution;
+
 } // namespace cetsp
 #endif // CETSP_HEURISTICS_H
@@ -6,6 +6,8 @@
 #include "common.h"
 #include "soc.h"
 #include "relaxed_solution.h"
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <numeric>
 #include <optional>
@@ -14,15 +16,18 @@ namespace cetsp {
 /**
  * Represent an intersection in a specific trajectory.
  * The intersection is between two edges of the cycles c1c2, c3c4 which have the
- * exact coordinates p1p2, p3p4
+ * exact coordinates p1p2, p3p4. The edges start at the positions `i` and `j`
+ * of the sequence of the relaxed solution.
  */
 struct TrajectoryIntersection {
 public:
   Point p1, p2, p3, p4;
   Circle c1, c2, c3, c4;
+  unsigned i, j;
   TrajectoryIntersection(Point p1, Point p2, Circle c1, Circle c2, Point p3,
-                         Point p4, Circle c3, Circle c4)
-      : p1(p1), p2(p2), c1(c1), c2(c2), p3(p3), p4(p4), c3(c3), c4(c4) {}
+                         Point p4, Circle c3, Circle c4, unsigned i, unsigned j)
+      : p1(p1), p2(p2), c1(c1), c2(c2), p3(p3), p4(p4), c3(c3), c4(c4), i(i),
+        j(j) {}
 };
 
 class Node {
@@ -35,6 +40,9 @@ public:
         parent{parent}, instance{instance} {
     if (parent != nullptr) {
       _depth = parent->depth() + 1;
+      bound_epoch = parent->bound_epoch; // shared by the whole tree
+    } else {
+      bound_epoch = std::make_shared<std::atomic<uint64_t>>(0);
     }
   }
 
@@ -42,12 +50,29 @@ public:
     _relaxed_solution.trigger_lazy_computation(true);
   }
 
+  /**
+   * Evaluates the node with an objective cutoff. If the SOC certifies that
+   * the objective is at least the cutoff, the node is pruned without keeping
+   * its trajectory, and `branch` will drop it. Otherwise, the certified bound of the SOC becomes the
+   * lower bound of the node. Only the node itself is modified, such that
+   * siblings can be evaluated in parallel.
+   * @param cutoff Usually (1-gap) times the upper bound.
+   * @return True if the node has been cut off and pruned.
+   */
+  bool trigger_lazy_evaluation(double cutoff);
+
   void add_lower_bound(double lb);
 
   auto get_lower_bound() -> double;
 
   bool is_feasible();
 
+  /**
+   * Sets the children of the node. Children that are already pruned, i.e.,
+   * have been cut off during their evaluation, are not kept. Only the
+   * minimum of their lower bounds is considered for the lower bound of this
+   * node.
+   */
   void branch(std::vector<std::shared_ptr<Node>> &children_);
 
   [[nodiscard]] const std::vector<std::shared_ptr<Node>> &get_children() const {
@@ -57,6 +82,29 @@ public:
     return children;
   }
 
+  /**
+   * Detaches an open child from this node, e.g., to spill it to disk. The
+   * lower bound of the child is kept and still considered for the lower bound
+   * of this node, such that the child can be freed.
+   * @param child The child to detach.
+   * @return A slot to pass to `attach_child` when reattaching the child.
+   */
+  size_t detach_child(const Node *child);
+
+  /**
+   * Reattaches a child that has been detached via `detach_child`.
+   * @param child The (recreated) child.
+   * @param slot The slot returned by `detach_child`.
+   */
+  void attach_child(std::shared_ptr<Node> child, size_t slot);
+
+  /**
+   * Frees the slot of a detached child that will not be reattached, e.g.,
+   * because this node has been pruned in the meantime.
+   * @param slot The slot returned by `detach_child`.
+   */
+  void release_detached_child(size_t slot);
+
   [[nodiscard]] Node *get_parent() { return parent; }
   [[nodiscard]] const Node *get_parent() const { return parent; }
 
@@ -94,7 +142,11 @@ public:
 
   void simplify() { _relaxed_solution.simplify(); }
 
-  [[nodiscard]] auto is_pruned() const -> bool { return pruned; }
+  /**
+   * A node is pruned if it or any of its ancestors has been pruned. This is
+   * resolved lazily, such that pruning does not have to walk the subtree.
+   */
+  [[nodiscard]] auto is_pruned() const -> bool;
 
   [[nodiscard]] Instance *get_instance() { return instance; }
 
@@ -107,12 +159,40 @@ private:
   void reevaluate_children();
 
   PartialSequenceSolution _relaxed_solution;
-  std::optional<double> lazy_lower_bound_value{};
+  // The own bound of the node, computing the relaxed solution if necessary.
+  double get_own_lower_bound();
+
+  /**
+   * The bounds are propagated lazily: Every node only stores its own bound
+   * and pruning state. The effective values also depend on the ancestors
+   * and are resolved on read. They are cached until the epoch of the tree
+   * changes, which happens whenever any bound in the tree is raised or a node
+   * is pruned. Reading a bound thus costs at most O(depth). Other trees, e.g.,
+   * of a portfolio, have their own epoch.
+   *
+   * The cache is written on read, so the effective bounds and the pruning
+   * state of a tree must only be read by one thread at a time, usually the
+   * one running the search. The evaluation of nodes on other threads (see
+   * `trigger_lazy_evaluation`) only writes the own state of the node.
+   */
+  std::shared_ptr<std::atomic<uint64_t>> bound_epoch;
+  void invalidate_bounds() { bound_epoch->fetch_add(1); }
+
+  std::optional<double> lazy_lower_bound_value{}; // own bound of the node
+  uint64_t cached_lower_bound_epoch = UINT64_MAX;
+  double cached_lower_bound = 0;
+  mutable uint64_t cached_pruned_epoch = UINT64_MAX;
+  mutable bool cached_pruned = false;
   std::vector<std::shared_ptr<Node>> children;
+  // lower bounds of the detached children, infinity for free slots.
+  std::vector<double> detached_lower_bounds;
+  size_t num_detached_children = 0;
+  // minimal lower bound of the children that have been cut off on branching.
+  double cut_off_lower_bound = std::numeric_limits<double>::infinity();
   Node *parent;
 
   int _depth = 0;
-  bool pruned = false;
+  bool pruned = false; // own pruning state, see `is_pruned`.
   Instance *instance;
 };
 } // namespace cetsp
@@ -0,0 +1,168 @@
+/**
+ * Which combination of root, branching, and search strategy works best
+ * depends heavily on the instance. The portfolio runs multiple configured
+ * BnB-algorithms on the same instance concurrently (one thread each). They
+ * share the solution pool (and thus the upper bound) and the best global
+ * lower bound. As soon as one member terminates, i.e., it proved the gap or
+ * explored its whole tree, all members are stopped.
+ *
+ * The members share the instance, so lazy constraints (callbacks adding
+ * circles) are not supported.
+ */
+#ifndef CETSP_PORTFOLIO_H
+#define CETSP_PORTFOLIO_H
+#include "cetsp/bnb.h"
+#include <atomic>
+#include <boost/thread/thread.hpp>
+#include <memory>
+#include <vector>
+namespace cetsp {
+
+namespace details {
+/**
+ * Exchanges the lower bound of a portfolio member with the other members.
+ * The lower bound of a root is a global lower bound for the instance, so
+ * it is valid for all members.
+ */
+class SharedLowerBoundCallback : public B2BNodeCallback {
+public:
+  explicit SharedLowerBoundCallback(std::atomic<double> *shared_lower_bound)
+      : shared_lower_bound{shared_lower_bound} {}
+
+  void on_entering_node(EventContext &context) override {
+    const auto shared_lb = shared_lower_bound->load();
+    if (context.root_node->get_lower_bound() < shared_lb) {
+      context.root_node->add_lower_bound(shared_lb);
+    }
+  }
+
+  void on_leaving_node(EventContext &context) override {
+    const auto lb = context.root_node->get_lower_bound();
+    auto shared_lb = shared_lower_bound->load();
+    while (shared_lb < lb &&
+           !shared_lower_bound->compare_exchange_weak(shared_lb, lb)) {
+    }
+  }
+
+private:
+  std::atomic<double> *shared_lower_bound;
+};
+} // namespace details
+
+class PortfolioSolver {
+public:
+  explicit PortfolioSolver(Instance *instance)
+      : instance{instance}, solution_pool{std::make_shared<SolutionPool>()} {}
+
+  /**
+   * Adds a member to the portfolio. Every member needs its own strategies.
+   * @param root The root node of the member, e.g., from a RootNodeStrategy.
+   * @param branching_strategy The branching strategy of the member.
+   * @param search_strategy The search strategy of the member.
+   * @return The BnB of the member, e.g., to add callbacks.
+   */
+  BranchAndBoundAlgorithm &add_member(std::shared_ptr<Node> root,
+                  std::unique_ptr<BranchingStrategy> branching_strategy,
+                  std::unique_ptr<SearchStrategy> search_strategy) {
+    Member member;
+    member.branching_strategy = std::move(branching_strategy);
+    member.search_strategy = std::move(search_strategy);
+    member.bnb = std::make_unique<BranchAndBoundAlgorithm>(
+        instance, std::move(root), *member.branching_strategy,
+        *member.search_strategy, solution_pool);
+    member.bnb->add_node_callback(
+        std::make_unique<details::SharedLowerBoundCallback>(&lower_bound));
+    members.push_back(std::move(member));
+    return *members.back().bnb;
+  }
+
+  /**
+   * Add a feasible solution as upper bound for all members.
+   */
+  void add_upper_bound(const Solution &solution) {
+    solution_pool->add_solution(solution);
+  }
+
+  double get_upper_bound() const { return solution_pool->get_upper_bound(); }
+
+  /**
+   * Returns the best lower bound of all members.
+   */
+  double get_lower_bound() {
+    auto lb = lower_bound.load();
+    for (auto &member : members) {
+      lb = std::max(lb, member.bnb->get_lower_bound());
+    }
+    return lb;
+  }
+
+  std::unique_ptr<Solution> get_solution() {
+    return solution_pool->get_best_solution();
+  }
+
+  /**
+   * Runs all members concurrently until one of them terminates or the
+   * time limit is reached.
+   * @param timelimit_s The timelimit in seconds, after which it aborts.
+   * @param gap Allowed optimality gap.
+   * @param verbose Defines if you want to see the progress log of the first
+   * member. The other members are always silent.
+   */
+  void optimize(int timelimit_s, double gap = 0.01, bool verbose = true) {
+    if (members.empty()) {
+      throw std::invalid_argument("Portfolio has no members.");
+    }
+    if (verbose) {
+      std::cout << "Running a portfolio of " << members.size()
+                << " BnB-algorithms." << std::endl;
+    }
+    std::atomic<int> winner{-1};
+    boost::thread_group tg;
+    for (unsigned i = 0; i < members.size(); ++i) {
+      tg.create_thread([this, i, timelimit_s, gap, verbose, &winner]() {
+        members[i].bnb->optimize(timelimit_s, gap, verbose && i == 0);
+        // The first member to finish stops all others.
+        int no_winner = -1;
+        if (winner.compare_exchange_strong(no_winner, static_cast<int>(i))) {
+          for (auto &member : members) {
+            member.bnb->stop();
+          }
+        }
+      });
+    }
+    tg.join_all();
+    first_finished = winner.load();
+    if (verbose) {
+      std::cout << "Portfolio member " << first_finished << " finished first. "
+                << get_lower_bound() << " | " << get_upper_bound()
+                << std::endl;
+    }
+  }
+
+  std::unordered_map<std::string, std::string> get_statistics() const {
+    std::unordered_map<std::string, std::string> stats;
+    stats["portfolio_size"] = std::to_string(members.size());
+    stats["portfolio_first_finished"] = std::to_string(first_finished);
+    for (unsigned i = 0; i < members.size(); ++i) {
+      for (const auto &[key, value] : members[i].bnb->get_statistics()) {
+        stats["member_" + std::to_string(i) + "_" + key] = value;
+      }
+    }
+    return stats;
+  }
+
+private:
+  struct Member {
+    std::unique_ptr<BranchingStrategy> branching_strategy;
+    std::unique_ptr<SearchStrategy> search_strategy;
+    std::unique_ptr<BranchAndBoundAlgorithm> bnb;
+  };
+
+  Instance *instance;
+  std::shared_ptr<SolutionPool> solution_pool;
+  std::atomic<double> lower_bound{0.0};
+  std::vector<Member> members;
+  int first_finished = -1;
+};
+} // namespace cetsp
+#endif // CETSP_PORTFOLIO_H
@@ -36,6 +36,20 @@ public:
     }));
   }
 
+  /**
+   * With an already computed trajectory for the sequence, e.g., from a
+   * different thread.
+   */
+  PartialSequenceSolution(const Instance *instance, std::vector<int> sequence_,
+                          Trajectory trajectory,
+                          std::vector<bool> spanning_info,
+                          double feasibility_tol = 0.001)
+      : PartialSequenceSolution(instance, std::move(sequence_),
+                                feasibility_tol) {
+    spanning_trajectory.update(std::move(trajectory),
+                               std::move(spanning_info));
+  }
+
   bool trigger_lazy_computation(bool with_feasibility = false) const {
     const auto fresh = spanning_trajectory.trigger_computation();
     if (with_feasibility) {
@@ -44,6 +58,24 @@ public:
     return fresh;
   }
 
+  /**
+   * Triggers the computation with an objective cutoff. If the SOC is cut off,
+   * no trajectory is computed (it would be computed exactly on access).
+   * @param cutoff Objective value above which the trajectory is not of
+   * interest.
+   * @return A certified lower bound on the objective.
+   */
+  double trigger_lazy_computation_with_cutoff(double cutoff) const {
+    return spanning_trajectory.trigger_computation(cutoff);
+  }
+
+  /**
+   * Returns true if the trajectory has already been computed.
+   */
+  [[nodiscard]] bool is_computed() const {
+    return spanning_trajectory.is_computed();
+  }
+
   /**
    * Returns true if the i-th circle in the sequence is spanning. This
    * information is useful to simplify the solution.
@@ -11,6 +11,7 @@
 #ifndef CETSP_SOC_H
 #define CETSP_SOC_H
 #include "common.h"
+#include <optional>
 #include <vector>
 namespace cetsp {
 
@@ -32,6 +33,59 @@ std::pair<Trajectory, std::vector<bool>>
 compute_trajectory_with_information(const std::vector<Circle> &circle_sequence,
                                     bool path);
 
+/**
+ * The result of a SOC with an objective cutoff.
+ */
+struct CutoffSocResult {
+  /**
+   * The trajectory and spanning information. Empty if the SOC has been
+   * cut off.
+   */
+  std::optional<std::pair<Trajectory, std::vector<bool>>> trajectory;
+  /**
+   * A lower bound on the optimal objective certified by a dual solution of
+   * the SOC. If cut off, it is at least the cutoff.
+   */
+  double lower_bound;
+
+  [[nodiscard]] bool is_cut_off() const { return !trajectory; }
+};
+
+/**
+ * Like `compute_trajectory_with_information`, but for use within the BnB:
+ * The SOC is only solved to a looser tolerance and a lower bound is derived
+ * from the dual solution given by the directions of the trajectory. It is
+ * valid for any tolerance, up to a relative rounding error of 1e-9 that is
+ * already subtracted. If the bound is at least `cutoff`, the trajectory is
+ * not of interest and is not returned.
+ * @param circle_sequence A sequence of circles.
+ * @param path Defines if we want a tour or a path.
+ * @param cutoff Objective value above which the trajectory is not of interest.
+ * @return The trajectory (if not cut off) and the certified lower bound.
+ */
+CutoffSocResult
+compute_trajectory_with_cutoff(const std::vector<Circle> &circle_sequence,
+                               bool path, double cutoff);
+
+/**
+ * Like `compute_trajectory_with_information`, but for a sequence of circle
+ * indices of the instance. For paths, the fixed endpoints of the instance are
+ * added without copying the sequence, and the spanning information only
+ * covers the sequence. The model is specialized for tours or paths at
+ * compile time.
+ */
+std::pair<Trajectory, std::vector<bool>>
+compute_trajectory_with_information(const Instance &instance,
+                                    const std::vector<int> &sequence);
+
+/**
+ * Version of `compute_trajectory_with_cutoff` for a sequence of circle
+ * indices of the instance.
+ */
+CutoffSocResult compute_trajectory_with_cutoff(const Instance &instance,
+                                               const std::vector<int> &sequence,
+                                               double cutoff);
+
 /**
  * Like `compute_trajectory_with_information`  but throwing away the
  * additional information, only returning the trajectory.
@@ -5,8 +5,10 @@
 #include "cetsp/common.h"
 #include "cetsp/details/cross_lower_bound.h"
 #include "cetsp/details/triple_map.h"
+#include "cetsp/diving_heuristic.h"
 #include "cetsp/heuristics.h"
 #include "cetsp/node.h"
+#include "cetsp/portfolio.h"
 #include "cetsp/strategies/rules/global_convex_hull_rule.h"
 #include "cetsp/strategies/rules/layered_convex_hull_rule.h"
 
@@ -19,58 +21,176 @@ struct cetsp_solution {
     double lower_bound;
     double upper_bound;
     std::vector<CGALPoint> points;
+    // The points in the order of the tour, as indices of the points passed to `solve`. Points that are covered
+    // implicitly, e.g., duplicates or points the tour passes on the way to others, may be missing.
+    std::vector<int> sequence;
     bool optimal_solution_found;
+    // see BranchAndBoundAlgorithm::get_statistics, e.g., the profiling counters
+    std::unordered_map<std::string, std::string> statistics;
 };
 
 namespace cetsp {
+    /**
+     * Converts the result of a BnB-algorithm or portfolio to a cetsp_solution.
+     * @param instance The solved instance, possibly reordered along a Hilbert curve.
+     * @param point_indices The index of the point for every circle of the instance before reordering, -1 for the
+     * start point.
+     */
+    template<typename Solver>
+    cetsp_solution to_cetsp_solution(Solver &solver, double gap, const Instance &instance,
+                                     const std::vector<int> &point_indices) {
+        auto result_points = std::vector<CGALPoint>();
+
+        auto solution = solver.get_solution();
+        auto trajectory = solution->get_trajectory();
+        for (const auto &p : trajectory.points) {
+            result_points.emplace_back(p.x, p.y);
+        }
+
+        auto sequence = std::vector<int>();
+        for (const auto i : instance.to_original_indices(solution->get_sequence())) {
+            if (point_indices[i] >= 0) {
+                sequence.push_back(point_indices[i]);
+            }
+        }
+
+        return cetsp_solution{solver.get_lower_bound(),
+                              solver.get_upper_bound(),
+                              result_points,
+                              sequence,
+                              solver.get_upper_bound() <= (1 + gap) * solver.get_lower_bound(),
+                              solver.get_statistics()
+        };
+    }
+
+    /**
+     * Solves the CETSP on the given points.
+     * @param portfolio If true, multiple strategy combinations race against
+     * each other on the threads (see PortfolioSolver).
+     * @param num_threads The number of threads to use, all hardware threads if 0.
+     * @param hilbert_order If true, the circles are renumbered along a Hilbert curve to improve the memory
+     * locality. The sequence of the solution is translated back to the indices of `points`.
+     */
     inline cetsp_solution solve(std::vector<CGALPoint> &points,
                          const std::shared_ptr<CGALPoint> &start_point,
                          double radius,
-                         double time) {
+                         double time,
+                         bool portfolio = false,
+                         unsigned num_threads = 0,
+                         bool hilbert_order = false) {
+        // The heuristics run before the BnB within the same time limit.
+        utils::Timer timer(time);
+        auto remaining_time = [&timer, time]() { return (int) std::max(0.0, time - timer.seconds()); };
         auto instance = Instance();
 
+        // The index in `points` of every circle of the instance, -1 for the start point.
+        auto point_indices = std::vector<int>();
+
         // If the start point is given we pass it as an initial point. Else use the default solver without a start.
         if (start_point) {
             auto center = Point(CGAL::to_double(start_point->x()), CGAL::to_double(start_point->y()));
             auto circle = Circle(center, 0);
             instance.add_circle(circle);
+            point_indices.push_back(-1);
         }
 
-        for (auto &p: points) {
-            auto center = Point(CGAL::to_double(p.x()), CGAL::to_double(p.y()));
+        for (int i = 0; i < static_cast<int>(points.size()); i++) {
+            auto center = Point(CGAL::to_double(points[i].x()), CGAL::to_double(points[i].y()));
             auto circle = Circle(center, radius);
+            const auto num_circles = instance.size();
             instance.add_circle(circle);
+            if (instance.size() > num_circles) { // not covered implicitly
+                point_indices.push_back(i);
+            }
+        }
+        if (hilbert_order) {
+            instance.reorder_along_hilbert_curve();
+        }
+
+        auto gap = 0.01;
+        if (num_threads == 0) {
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        // For large instances, the BnB cannot even close the root gap in time,
+        // so a part of the time is spent on a decomposition heuristic.
+        constexpr size_t LARGE_INSTANCE_SIZE = 1000;
+        constexpr double CLUSTERING_TIME_SHARE = 0.1;
+        auto configure = [gap](CircleBranching &branching_strategy, bool ch_rules) {
+            branching_strategy.enable_objective_cutoff(gap);
+            if (ch_rules) { // requires a root obeying the convex hull order
+                branching_strategy.add_rule(std::make_unique<GlobalConvexHullRule>());
+                branching_strategy.add_rule(std::make_unique<LayeredConvexHullRule>());
+            }
+        };
+
+        if (portfolio) {
+            // Race different strategy combinations, splitting the threads among them.
+            const auto member_threads = std::max(1u, num_threads / 4);
+            PortfolioSolver portfolio_solver(&instance);
+            ConvexHullRoot ch_root;
+            LongestEdgePlusFurthestCircle le_root;
+            {
+                auto branching_strategy = std::make_unique<ChFarthestCircle>(false, member_threads);
+                configure(*branching_strategy, true);
+                portfolio_solver.add_member(ch_root.get_root_node(instance), std::move(branching_strategy),
+                                            std::make_unique<CheapestChildDepthFirst>());
+            }
+            // The breadth first members can grow large open lists, the cold nodes are spilled to disk.
+            constexpr size_t SPILL_MEMORY_BUDGET = size_t(1) << 30;
+            auto spilling_dfs_bfs = [&]() {
+                auto search_strategy = std::make_unique<DfsBfs>();
+                search_strategy->enable_spilling(details::NodeSpill::temporary_path(), SPILL_MEMORY_BUDGET);
+                return search_strategy;
+            };
+            {
+                auto branching_strategy = std::make_unique<ChFarthestCircle>(false, member_threads);
+                configure(*branching_strategy, true);
+                portfolio_solver.add_member(ch_root.get_root_node(instance), std::move(branching_strategy),
+                                            spilling_dfs_bfs());
+            }
+            {
+                auto branching_strategy = std::make_unique<FarthestCircle>(false, member_threads);
+                configure(*branching_strategy, true);
+                auto search_strategy = std::make_unique<CheapestBreadthFirst>();
+                search_strategy->enable_spilling(details::NodeSpill::temporary_path(), SPILL_MEMORY_BUDGET);
+                auto &bnb = portfolio_solver.add_member(ch_root.get_root_node(instance),
+                                                        std::move(branching_strategy), std::move(search_strategy));
+                // Breadth first rarely reaches feasible nodes, the dives provide its incumbents.
+                bnb.add_node_callback(std::make_unique<DivingHeuristicCallback>());
+            }
+            {
+                auto branching_strategy = std::make_unique<FarthestCircle>(false, member_threads);
+                configure(*branching_strategy, false);
+                portfolio_solver.add_member(le_root.get_root_node(instance), std::move(branching_strategy),
+                                            spilling_dfs_bfs());
+            }
+            portfolio_solver.add_upper_bound(compute_tour_by_2opt(instance));
+            if (instance.size() >= LARGE_INSTANCE_SIZE) {
+                portfolio_solver.add_upper_bound(
+                        compute_tour_by_clustering(instance, 150, CLUSTERING_TIME_SHARE * time, num_threads));
+            }
+            portfolio_solver.optimize(remaining_time(), gap);
+            return to_cetsp_solution(portfolio_solver, gap, instance, point_indices);
         }
 
         auto rns = std::make_unique<ConvexHullRoot>();
 
-        auto branching_strategy = std::make_unique<ChFarthestCircle>(false,
-                                                                     std::thread::hardware_concurrency());
+        auto branching_strategy = std::make_unique<ChFarthestCircle>(false, num_threads);
+        configure(*branching_strategy, true);
 
         auto search_strategy = std::make_unique<CheapestChildDepthFirst>();
 
-        branching_strategy->add_rule(std::make_unique<GlobalConvexHullRule>());
-        branching_strategy->add_rule(std::make_unique<LayeredConvexHullRule>());
-
         BranchAndBoundAlgorithm baba(&instance, rns->get_root_node(instance),
                                      *branching_strategy, *search_strategy);
 
         baba.add_upper_bound(compute_tour_by_2opt(instance));
-
-        auto gap = 0.01;
-        baba.optimize((int) time, gap);
-        auto result_points = std::vector<CGALPoint>();
-
-        auto trajectory = baba.get_solution()->get_trajectory();
-        for (const auto &p : trajectory.points) {
-            result_points.emplace_back(p.x, p.y);
+        if (instance.size() >= LARGE_INSTANCE_SIZE) {
+            baba.add_upper_bound(
+                    compute_tour_by_clustering(instance, 150, CLUSTERING_TIME_SHARE * time, num_threads));
         }
 
-        return cetsp_solution{baba.get_lower_bound(),
-                              baba.get_upper_bound(),
-                              result_points,
-                              baba.get_upper_bound() <= (1 + gap) * baba.get_lower_bound()
-        };
+        baba.optimize(remaining_time(), gap);
+        return to_cetsp_solution(baba, gap, instance, point_indices);
     }
 }
 #endif
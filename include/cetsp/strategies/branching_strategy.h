@@ -19,9 +19,11 @@
 #define CETSP_BRANCHING_STRATEGY_H
 #include "../common.h"
 #include "../details/convex_hull_order.h"
+#include "../details/profiling.h"
 #include "../details/solution_pool.h"
 #include "../details/triple_map.h"
 #include "../node.h"
+#include "../utils/log.h"
 #include "rule.h"
 #include <CGAL/Convex_hull_traits_adapter_2.h>
 #include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
@@ -52,6 +54,15 @@ public:
    * @return True iff the node has children.
    */
   virtual bool branch(Node &node) = 0;
+
+  /**
+   * Checks if lazy constraints have invalidated earlier branching decisions,
+   * e.g., because a rule excluded branches that are needed for the extended
+   * instance. Excluded branches cannot be recovered, so the BnB restarts
+   * from the root. Resets the request.
+   * @return True if the search has to restart from the root.
+   */
+  virtual bool requires_restart() { return false; }
   virtual ~BranchingStrategy() = default;
 };
 
@@ -59,8 +70,7 @@ public:
  * The idea of Circle Branching is to add an still uncovered circle to the
  * sequence. This should be the most sensible branching strategy for most
  * cases, but it is not the only one. For example in case of intersections,
- * we know that the intersection has to be resolved and we could branch on
- * all ways to add a circle to the two edges in the .intersection.
+ * we know that the intersection has to be resolved, see IntersectionBranching.
  *
  * This is an abstract class and you need to specify how to choose the circle.
  * The most sensible approach should be to add the circle most distanced to
@@ -71,14 +81,16 @@ public:
   explicit CircleBranching(bool simplify = false, size_t num_threads = 1)
       : simplify{simplify}, num_threads{num_threads} {
     if (simplify) {
-      std::cout << "Using node simplification." << std::endl;
+      utils::log() << "Using node simplification." << std::endl;
     }
-    std::cout << "Exploring on " << num_threads << " threads" << std::endl;
+    utils::log() << "Exploring on " << num_threads << " threads" << std::endl;
   }
 
   void setup(Instance *instance_, std::shared_ptr<Node> &root,
              SolutionPool *solution_pool) override {
     instance = instance_;
+    this->solution_pool = solution_pool;
+    instance_revision = instance->revision;
     for (auto &rule : rules) {
       rule->setup(instance, root, solution_pool);
     }
@@ -90,7 +102,35 @@ public:
 
   bool branch(Node &node) override;
 
+  /**
+   * Required once a rule reports that its earlier decisions are no longer
+   * valid, see `SequenceRule::on_instance_change`.
+   */
+  bool requires_restart() override;
+
+  /**
+   * Use the current upper bound as cutoff for the SOCs of the children.
+   * Children that are certified to have a lower bound of at least
+   * (1-gap)*UB are pruned right away without solving their SOC to optimality.
+   * The other children are solved to a looser tolerance and get the
+   * certified dual bound as lower bound.
+   * @param gap The optimality gap of the BnB.
+   */
+  void enable_objective_cutoff(double gap) { cutoff_gap = gap; }
+
 protected:
+  /**
+   * Creates the children inserting circle `c` at every position of the
+   * sequence that is allowed by the rules. The children are not evaluated.
+   */
+  std::vector<std::shared_ptr<Node>> create_children(Node &node, int c);
+
+  /**
+   * The objective cutoff for the children, infinite if disabled or no upper
+   * bound is known.
+   */
+  [[nodiscard]] double get_cutoff() const;
+
   /**
    * Override this method to filter the branching in advance.
    * @param sequence Sequence to be checked for a potential branch.
@@ -98,6 +138,8 @@ protected:
    */
   virtual bool is_sequence_ok(const std::vector<int> &sequence,
                               const Node &parent) {
+    CETSP_PROFILE_SCOPE(RULES);
+    update_rules();
     return std::all_of(rules.begin(), rules.end(),
                        [&sequence, &parent](auto &rule) {
                          return rule->is_ok(sequence, parent);
@@ -112,10 +154,19 @@ protected:
    */
   virtual std::optional<int> get_branching_circle(Node &node) = 0;
 
+  /**
+   * Informs the rules about circles added since the last call.
+   */
+  void update_rules();
+
   Instance *instance = nullptr;
   bool simplify;
   size_t num_threads;
+  std::optional<double> cutoff_gap;
+  SolutionPool *solution_pool = nullptr;
   std::vector<std::unique_ptr<SequenceRule>> rules;
+  int instance_revision = 0; // the revision the rules have been updated to.
+  bool restart_required = false; // set if a rule invalidated its decisions.
 };
 
 /**
@@ -126,21 +177,55 @@ class FarthestCircle : public CircleBranching {
 public:
   explicit FarthestCircle(bool simplify = false, size_t num_threads = 1)
       : CircleBranching{simplify, num_threads} {
-    std::cout << "Branching on farthest circle." << std::endl;
+    utils::log() << "Branching on farthest circle." << std::endl;
   }
 
 protected:
   std::optional<int> get_branching_circle(Node &node) override;
 };
 
+/**
+ * Strong branching: Instead of branching on the farthest circle, the children
+ * of the `num_candidates` farthest circles are evaluated (in parallel on the
+ * threads) and the branch is done on the circle whose weakest child has the
+ * highest lower bound, as it should shrink the tree the most. The children of
+ * this probe are used directly. With an objective cutoff, the probes are
+ * solved with the looser tolerance, which makes them cheaper.
+ *
+ * The probes cost `num_candidates` times the SOCs of a normal branch. They
+ * pay off only close to the root, where a good decision shrinks large
+ * subtrees. Deeper nodes are branched on the farthest circle.
+ */
+class StrongBranchingFarthestCircle : public FarthestCircle {
+public:
+  explicit StrongBranchingFarthestCircle(size_t num_candidates = 3,
+                                         bool simplify = false,
+                                         size_t num_threads = 1,
+                                         int max_probe_depth = 3)
+      : FarthestCircle{simplify, num_threads},
+        num_candidates{std::max<size_t>(1, num_candidates)},
+        max_probe_depth{max_probe_depth} {
+    utils::log() << "Strong branching on the " << this->num_candidates
+                 << " farthest circles up to depth " << max_probe_depth << "."
+                 << std::endl;
+  }
+
+  bool branch(Node &node) override;
+
+private:
+  size_t num_candidates;
+  int max_probe_depth;
+};
+
 /**
  * This strategy will only create branches that satisfy the CCW order of the
  * convex hull. A dependency is that the root is also obeying this rule.
  * We can proof that any optimal solution has follow the order of circles
  * intersecting the convex hull on the circle centers.
  *
- * This does not allow lazy constraints! (or only those that do not change
- * the convex hull).
+ * Lazy constraints are only cheap as long as they do not change the convex
+ * hull. A circle that changes it disables the rules and the BnB restarts
+ * from the root, losing the whole tree, see GlobalConvexHullRule.
  */
 class ChFarthestCircle : public FarthestCircle {
 
@@ -148,6 +233,34 @@ public:
   explicit ChFarthestCircle(bool simplify = true, size_t num_threads = 1);
 };
 
+/**
+ * Any optimal tour is free of self-intersections. If the relaxed trajectory
+ * of a node crosses itself, this strategy additionally creates one child per
+ * crossing that resolves it by reversing the part of the sequence between the
+ * two crossing edges (a 2-opt move). These children reach crossing-free
+ * sequences, and thus good solutions, directly. The children of the farthest
+ * circle are still created, as a crossing of the relaxed trajectory can also
+ * be resolved by the circles that are still missing. Thus, the children cover
+ * all solutions of the node and the optimum is the same as for FarthestCircle.
+ * Without a crossing (or for paths), it is just FarthestCircle.
+ */
+class IntersectionBranching : public FarthestCircle {
+public:
+  explicit IntersectionBranching(bool simplify = false, size_t num_threads = 1)
+      : FarthestCircle{simplify, num_threads} {
+    utils::log() << "Resolving intersections by reordering." << std::endl;
+  }
+
+  bool branch(Node &node) override;
+
+private:
+  /**
+   * Creates a child for every crossing of the relaxed trajectory that is
+   * resolved by a 2-opt move on the sequence. The children are not evaluated.
+   */
+  std::vector<std::shared_ptr<Node>> create_uncrossed_children(Node &node);
+};
+
 /**
  * Just a random branching  strategy as comparison. It will branch on a random
  * not yet covered circle.
@@ -157,7 +270,7 @@ class RandomCircle : public CircleBranching {
 public:
   explicit RandomCircle(bool simplify = false, size_t num_threads = 1)
       : CircleBranching{simplify, num_threads} {
-    std::cout << "Branching on random circle" << std::endl;
+    utils::log() << "Branching on random circle" << std::endl;
   }
 
 protected:
@@ -28,6 +28,15 @@ public:
   virtual void setup(const Instance *instance, std::shared_ptr<Node> &root,
                      SolutionPool *solution_pool) = 0;
   virtual bool is_ok(const std::vector<int> &seq, const Node &parent) = 0;
+  /**
+   * Called before the next check if circles have been added to the instance
+   * since the last call, e.g., by lazy constraints (see `Instance::revision`).
+   * @return True if sequences of the previous circles that have been excluded
+   * may be needed for the extended instance. The excluded branches cannot be
+   * recovered, so the BnB restarts from the root. The rule has to accept
+   * the root sequence afterwards.
+   */
+  virtual bool on_instance_change() { return false; }
   virtual ~SequenceRule() = default;
 };
 
@@ -5,11 +5,22 @@
 #ifndef CETSP_GLOBAL_CONVEX_HULL_RULE_H
 #define CETSP_GLOBAL_CONVEX_HULL_RULE_H
 #include "../../common.h"
+#include "../../details/convex_hull_order.h"
 #include "../../details/solution_pool.h"
 #include "../../node.h"
 #include "../rule.h"
 namespace cetsp {
 
+/**
+ * Only allows sequences that visit the circles intersecting the convex hull
+ * of the circle centers in the order of the hull.
+ *
+ * Circles added lazily inside the hull only get their own order value. If a
+ * circle extends the hull, the order of the previous circles changes and
+ * branches excluded by the old order may be needed. The rule is then
+ * disabled for the rest of the run and the BnB restarts from the root, so the
+ * initial instance should contain the extreme circles.
+ */
 class GlobalConvexHullRule : public SequenceRule {
 public:
   virtual void setup(const Instance *instance, std::shared_ptr<Node> &root,
@@ -20,15 +31,19 @@ public:
                             const std::vector<bool> &is_in_ch,
                             const std::vector<double> &order_values);
   virtual bool is_ok(const std::vector<int> &seq, const Node &parent);
+  bool on_instance_change() override;
 
 private:
   const Instance *instance = nullptr;
+  std::optional<details::ConvexHullOrder> hull;
   std::vector<double> order_values;
   std::vector<bool> is_ordered;
+  bool disabled = false; // set when a lazy circle changed the hull.
 
   bool sequence_is_ch_ordered(const std::vector<int> &sequence);
   std::vector<Point> get_circle_centers(const Instance &instance) const;
-  void compute_weights(const Instance *instance, std::shared_ptr<Node> &root);
+  void compute_weights(const Instance *instance);
+  void compute_weight(unsigned i);
 };
 } // namespace cetsp
 #endif // CETSP_GLOBAL_CONVEX_HULL_RULE_H
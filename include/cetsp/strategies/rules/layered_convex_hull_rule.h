@@ -6,6 +6,7 @@
 #define CETSP_LAYERED_CONVEX_HULL_RULE_H
 
 #include "../../common.h"
+#include "../../details/convex_hull_order.h"
 #include "../../details/solution_pool.h"
 #include "../../node.h"
 #include "../rule.h"
@@ -32,21 +33,34 @@ public:
    * q in the input. The size of hull_to_global_map is the number of vertices in
    * the layer CH. */
   std::vector<unsigned int> hull_to_global_map;
+  /* The convex hull of the layer, used to check if added circles change it. */
+  std::optional<details::ConvexHullOrder> hull;
 
   bool is_in_hull(unsigned int i) const {
     auto opt = global_to_hull_map[i];
     return opt ? true : false;
   }
 
-  static std::vector<ConvexHullLayer> calc_ch_layers(const Instance &instance);
+  /* Computes the layers of all circles that are not yet in one of the given
+   * (outer) layers. */
+  static std::vector<ConvexHullLayer>
+  calc_ch_layers(const Instance &instance,
+                 std::vector<ConvexHullLayer> layers = {});
 };
 
+/*
+ * Lazily added circles only rebuild the layers starting from the outermost
+ * layer they touch. If a circle changes the hull of a layer, the layers of
+ * the previous circles change. As for the GlobalConvexHullRule, the rule is
+ * then disabled for the rest of the run and the BnB restarts from the root.
+ */
 class LayeredConvexHullRule : public SequenceRule {
 public:
   void setup(const Instance *instance, std::shared_ptr<Node> &root,
              SolutionPool *solution_pool) override;
 
   bool is_ok(const std::vector<int> &seq, const Node &parent) override;
+  bool on_instance_change() override;
   bool is_ok(const std::vector<int> &seq) const;
 
   const ConvexHullLayer &get_layer(unsigned int layer_idx) const {
@@ -61,6 +75,8 @@ private:
 
   const Instance *instance = nullptr;
   std::vector<ConvexHullLayer> layers;
+  size_t num_circles = 0; // the number of circles in the layers
+  bool disabled = false;  // set when a lazy circle changed a hull.
 };
 
 } // namespace cetsp
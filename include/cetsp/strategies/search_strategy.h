@@ -11,11 +11,28 @@
 #ifndef CETSP_SEARCH_STRATEGY_H
 #define CETSP_SEARCH_STRATEGY_H
 #include "branching_strategy.h"
+#include "cetsp/details/node_spill.h"
 #include "cetsp/node.h"
 #include <algorithm>
+#include <numeric>
 
 namespace cetsp {
 
+/**
+ * Returns the children of the node that have not been pruned. Children may be
+ * pruned right on creation, e.g., by an objective cutoff. Those do not have
+ * to be queued and may not even have a trajectory.
+ */
+inline std::vector<std::shared_ptr<Node>> unpruned_children(Node &node) {
+  std::vector<std::shared_ptr<Node>> children;
+  for (auto &child : node.get_children()) {
+    if (!child->is_pruned()) {
+      children.push_back(child);
+    }
+  }
+  return children;
+}
+
 class SearchStrategy {
 public:
   virtual void init(std::shared_ptr<Node> &root) = 0;
@@ -50,19 +67,37 @@ public:
    */
   virtual void notify_of_prune(Node &node){};
 
+  /**
+   * The number of open nodes, used for statistics. May include nodes that
+   * have been pruned in the meantime.
+   */
+  [[nodiscard]] virtual size_t get_num_open_nodes() const { return 0; }
+
   virtual ~SearchStrategy() = default;
 };
 
 class DfsBfs : public SearchStrategy {
 public:
   void init(std::shared_ptr<Node> &root) override {
-    std::cout << "Using DfsBfs search" << std::endl;
-    queue.emplace_back(root, root->get_lower_bound(),
-                       root->get_relaxed_solution().obj());
+    utils::log() << "Using DfsBfs search" << std::endl;
+    push(root);
+  }
+
+  /**
+   * Spill cold open nodes to a memory-mapped file once the open nodes are
+   * estimated to use more than the memory budget. Spilled nodes are
+   * reloaded in best-bound order when the search switches to the cheapest
+   * node or runs out of resident nodes.
+   * @param path The spill file. It is removed when the strategy is destroyed.
+   * @param memory_budget_bytes The memory budget for the open nodes.
+   */
+  void enable_spilling(const std::string &path, size_t memory_budget_bytes) {
+    spill = std::make_unique<details::NodeSpill>(path);
+    memory_budget = memory_budget_bytes;
   }
 
   void notify_of_branch(Node &node) override {
-    auto children = node.get_children();
+    auto children = unpruned_children(node);
     std::sort(children.begin(), children.end(),
               [](std::shared_ptr<Node> &a, std::shared_ptr<Node> &b) {
                 const auto lb_a = a->get_lower_bound();
@@ -74,9 +109,9 @@ public:
                 return a->get_lower_bound() > b->get_lower_bound();
               });
     for (auto &child : children) {
-      queue.emplace_back(child, child->get_lower_bound(),
-                         child->get_relaxed_solution().obj());
+      push(child);
     }
+    spill_cold_nodes();
   }
 
   void notify_of_feasible(Node &node) override {
@@ -90,17 +125,24 @@ public:
       return nullptr;
     }
     auto n = queue.back();
-    queue.pop_back();
+    pop();
     return std::get<0>(n);
   }
   bool has_next() override {
     // remove all pruned entries  from  the back
     while (!queue.empty() && std::get<0>(queue.back())->is_pruned()) {
-      queue.pop_back();
+      pop();
+    }
+    if (queue.empty()) {
+      reload_spilled_nodes();
     }
     return !queue.empty();
   }
 
+  [[nodiscard]] size_t get_num_open_nodes() const override {
+    return queue.size() + (spill ? spill->size() : 0);
+  }
+
 private:
   void sort_to_priotize_lowest_value() {
     std::sort(queue.begin(), queue.end(), [](auto &a, auto &b) {
@@ -111,16 +153,84 @@ private:
       }
       return lb_a > lb_b;
     });
+    reload_spilled_nodes();
+  }
+
+  void push(const std::shared_ptr<Node> &node) {
+    // The estimate grows with the instance, so the bytes added here are
+    // stored to subtract exactly them again.
+    const auto bytes = spill ? details::estimate_memory_usage(*node) : 0;
+    queue.emplace_back(node, node->get_lower_bound(),
+                       node->get_relaxed_solution().obj(), bytes);
+    resident_bytes += bytes;
+  }
+
+  void pop() {
+    resident_bytes -= std::get<3>(queue.back());
+    queue.pop_back();
+  }
+
+  /**
+   * Spills the nodes with the highest lower bounds (the least promising ones)
+   * until only half of the memory budget is used. The depth first order of
+   * the remaining nodes is kept.
+   */
+  void spill_cold_nodes() {
+    if (!spill || resident_bytes <= memory_budget) {
+      return;
+    }
+    std::vector<size_t> by_bound(queue.size());
+    std::iota(by_bound.begin(), by_bound.end(), 0);
+    std::sort(by_bound.begin(), by_bound.end(), [this](size_t a, size_t b) {
+      return std::get<0>(queue[a])->get_lower_bound() >
+             std::get<0>(queue[b])->get_lower_bound();
+    });
+    std::vector<bool> removed(queue.size(), false);
+    for (size_t i = 0;
+         i < by_bound.size() && resident_bytes > memory_budget / 2; ++i) {
+      auto &node = std::get<0>(queue[by_bound[i]]);
+      if (node->is_pruned() || spill->spill(*node)) {
+        resident_bytes -= std::get<3>(queue[by_bound[i]]);
+        removed[by_bound[i]] = true;
+      }
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < queue.size(); ++i) {
+      if (!removed[i]) {
+        queue[kept++] = std::move(queue[i]);
+      }
+    }
+    queue.resize(kept);
   }
 
-  std::vector<std::tuple<std::shared_ptr<Node>, double, double>> queue;
+  /**
+   * Reloads spilled nodes as long as they have a lower bound than the next
+   * resident node.
+   */
+  void reload_spilled_nodes() {
+    while (spill && !spill->empty() &&
+           (queue.empty() ||
+            spill->get_lower_bound() < std::get<1>(queue.back()))) {
+      auto node = spill->reload();
+      if (node) {
+        push(node);
+      }
+    }
+  }
+
+  // The node, its lower bound and objective for sorting, and its resident
+  // bytes.
+  std::vector<std::tuple<std::shared_ptr<Node>, double, double, size_t>> queue;
+  std::unique_ptr<details::NodeSpill> spill;
+  size_t memory_budget = 0;
+  size_t resident_bytes = 0;
 };
 class CheapestChildDepthFirst : public SearchStrategy {
 public:
   void init(std::shared_ptr<Node> &root) override { queue.push_back(root); }
 
   void notify_of_branch(Node &node) override {
-    auto children = node.get_children();
+    auto children = unpruned_children(node);
     std::sort(children.begin(), children.end(),
               [](std::shared_ptr<Node> &a, std::shared_ptr<Node> &b) {
                 const auto lb_a = a->get_lower_bound();
@@ -152,47 +262,127 @@ public:
     return !queue.empty();
   }
 
+  [[nodiscard]] size_t get_num_open_nodes() const override {
+    return queue.size();
+  }
+
 private:
   std::vector<std::shared_ptr<Node>> queue;
 };
 class CheapestBreadthFirst : public SearchStrategy {
 public:
-  void init(std::shared_ptr<Node> &root) override { queue.push_back(root); }
+  void init(std::shared_ptr<Node> &root) override { push(root); }
+
+  /**
+   * Spill cold open nodes to a memory-mapped file once the open nodes are
+   * estimated to use more than the memory budget. Spilled nodes are
+   * reloaded as soon as they are the cheapest nodes.
+   * @param path The spill file. It is removed when the strategy is destroyed.
+   * @param memory_budget_bytes The memory budget for the open nodes.
+   */
+  void enable_spilling(const std::string &path, size_t memory_budget_bytes) {
+    spill = std::make_unique<details::NodeSpill>(path);
+    memory_budget = memory_budget_bytes;
+  }
 
   void notify_of_branch(Node &node) override {
-    for (auto &child : node.get_children()) {
-      queue.push_back(child);
+    for (auto &child : unpruned_children(node)) {
+      push(child);
     }
-    std::sort(queue.begin(), queue.end(),
-              [](std::shared_ptr<Node> &a, std::shared_ptr<Node> &b) {
-                const auto lb_a = a->get_lower_bound();
-                const auto lb_b = b->get_lower_bound();
-                if (std::abs(lb_a - lb_b) < 0.001) { // approx equal
-                  return a->get_relaxed_solution().obj() >
-                         b->get_relaxed_solution().obj();
-                }
-                return lb_a > lb_b;
-              });
+    std::sort(queue.begin(), queue.end(), [](auto &a, auto &b) {
+      const auto lb_a = a.first->get_lower_bound();
+      const auto lb_b = b.first->get_lower_bound();
+      if (std::abs(lb_a - lb_b) < 0.001) { // approx equal
+        return a.first->get_relaxed_solution().obj() >
+               b.first->get_relaxed_solution().obj();
+      }
+      return lb_a > lb_b;
+    });
+    spill_cold_nodes();
   }
 
   std::shared_ptr<Node> next() override {
     if (!has_next()) {
       return nullptr;
     }
-    auto n = queue.back();
-    queue.pop_back();
+    auto n = queue.back().first;
+    pop();
     return n;
   }
   bool has_next() override {
-    // remove all pruned entries  from  the back
-    while (!queue.empty() && queue.back()->is_pruned()) {
-      queue.pop_back();
-    }
+    do {
+      // remove all pruned entries  from  the back
+      while (!queue.empty() && queue.back().first->is_pruned()) {
+        pop();
+      }
+    } while (reload_spilled_node());
     return !queue.empty();
   }
 
+  [[nodiscard]] size_t get_num_open_nodes() const override {
+    return queue.size() + (spill ? spill->size() : 0);
+  }
+
 private:
-  std::vector<std::shared_ptr<Node>> queue;
+  void push(const std::shared_ptr<Node> &node) {
+    // The estimate grows with the instance, so the bytes added here are
+    // stored to subtract exactly them again.
+    const auto bytes = spill ? details::estimate_memory_usage(*node) : 0;
+    queue.emplace_back(node, bytes);
+    resident_bytes += bytes;
+  }
+
+  void pop() {
+    resident_bytes -= queue.back().second;
+    queue.pop_back();
+  }
+
+  /**
+   * Spills the nodes at the front of the queue (highest lower bounds) until
+   * only half of the memory budget is used.
+   */
+  void spill_cold_nodes() {
+    if (!spill || resident_bytes <= memory_budget) {
+      return;
+    }
+    decltype(queue) retained;
+    size_t i = 0;
+    for (; i < queue.size() && resident_bytes > memory_budget / 2; ++i) {
+      auto &[node, bytes] = queue[i];
+      if (node->is_pruned() || spill->spill(*node)) {
+        resident_bytes -= bytes;
+      } else {
+        retained.push_back(queue[i]);
+      }
+    }
+    queue.erase(queue.begin(), queue.begin() + static_cast<long>(i));
+    queue.insert(queue.begin(), retained.begin(), retained.end());
+  }
+
+  /**
+   * Reloads the cheapest spilled node if it is cheaper than the cheapest
+   * resident node.
+   * @return True if a node has been reloaded.
+   */
+  bool reload_spilled_node() {
+    if (!spill || spill->empty() ||
+        (!queue.empty() &&
+         spill->get_lower_bound() >= queue.back().first->get_lower_bound())) {
+      return false;
+    }
+    auto node = spill->reload();
+    if (!node) {
+      return false;
+    }
+    push(node);
+    return true;
+  }
+
+  // The nodes with their resident bytes.
+  std::vector<std::pair<std::shared_ptr<Node>, size_t>> queue;
+  std::unique_ptr<details::NodeSpill> spill;
+  size_t memory_budget = 0;
+  size_t resident_bytes = 0;
 };
 
 class RandomNextNode : public SearchStrategy {
@@ -229,6 +419,10 @@ public:
     return !queue.empty();
   }
 
+  [[nodiscard]] size_t get_num_open_nodes() const override {
+    return queue.size();
+  }
+
 private:
   std::vector<std::shared_ptr<Node>> queue;
 };
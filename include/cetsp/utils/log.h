@@ -0,0 +1,42 @@
+//
+// Log messages of the strategies, which can be silenced per thread.
+//
+
+#ifndef CETSP_LOG_H
+#define CETSP_LOG_H
+#include <iostream>
+#include <ostream>
+namespace cetsp::utils {
+
+inline bool &is_quiet() {
+  thread_local bool quiet = false;
+  return quiet;
+}
+
+/**
+ * The stream for the informational messages of the strategies, e.g., which
+ * strategy is used. Discards the messages while a `QuietScope` is active on
+ * the current thread.
+ */
+inline std::ostream &log() {
+  thread_local std::ostream discard(nullptr);
+  return is_quiet() ? discard : std::cout;
+}
+
+/**
+ * Silences `log` on the current thread until the end of the scope, e.g., for
+ * BnB-algorithms that are used as a subroutine on parallel threads.
+ */
+class QuietScope {
+public:
+  QuietScope() : previous{is_quiet()} { is_quiet() = true; }
+  QuietScope(const QuietScope &) = delete;
+  QuietScope &operator=(const QuietScope &) = delete;
+  ~QuietScope() { is_quiet() = previous; }
+
+private:
+  bool previous;
+};
+} // namespace cetsp::utils
+
+#endif // CETSP_LOG_H
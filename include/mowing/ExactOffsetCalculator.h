@@ -17,6 +17,7 @@
 // Approximation stuff
 #include <CGAL/approximated_offset_2.h>
 #include <CGAL/Gps_circle_segment_traits_2.h>
+#include <CGAL/General_polygon_set_2.h>
 #include <CGAL/Polygon_convex_decomposition_2.h>
 
 
@@ -50,9 +51,37 @@ namespace mowing {
 
         typedef std::vector<Polygon_with_holes_2> ConicPolygonVector;
 
-        ExactOffsetCalculator(Input_Linear_polygon &polygon, double radius, bool verbose = false);
+        // Circle-segment traits for the fast path
+        typedef CGAL::Gps_circle_segment_traits_2<InputKernel> Circle_segment_traits;
+        typedef CGAL::General_polygon_set_2<Circle_segment_traits> Circle_segment_polygon_set_2;
+        typedef Circle_segment_traits::Polygon_2 Circle_segment_polygon_2;
+        typedef Circle_segment_traits::Polygon_with_holes_2 Circle_segment_polygon_with_holes_2;
+
+        /**
+         * @param circle_segment_fast_path Additionally maintains the uncovered regions with circle-segment traits,
+         * subtracting a slightly smaller approximated coverage. If this already leaves nothing uncovered, the
+         * coverage is certified and the (much slower) conic difference is skipped. Otherwise, or if the
+         * approximation fails, the exact conic difference is done, so the results are the same as without it.
+         */
+        ExactOffsetCalculator(Input_Linear_polygon &polygon, double radius, bool verbose = false,
+                              bool circle_segment_fast_path = false);
         void initializeUncoveredRegions();
         void computeUncoveredRegions(std::vector<Input_Point> &points, bool interpret_as_path = false);
+
+        /**
+         * Incremental version of computeUncoveredRegions for a tour whose coverage has already been subtracted
+         * and that has been extended by closed subtours. The Minkowski sum of a union is the union of the
+         * Minkowski sums, so subtracting only the subtours yields exactly the same uncovered regions.
+         */
+        void subtractAddedSubtours(std::vector<std::vector<Input_Point>> &subtours);
+
+        /**
+         * Splits the bounding box of the polygon into tiles_x * tiles_y tiles. The uncovered regions of the tiles
+         * are computed in parallel on num_threads threads, every tile only with the tour parts whose offset reaches
+         * it. Tour polygons reaching several tiles are split into their edges, such that the tiles do not repeat
+         * the whole offset. The tiles are joined into polygon_set afterwards. Resets the uncovered regions.
+         */
+        void enableTiling(std::size_t tiles_x, std::size_t tiles_y, unsigned num_threads);
         Polygon_2 convert_input_polygon(Input_Linear_polygon &polygon);
 
         Polygon_set_2 polygon_set;
@@ -60,11 +89,45 @@ namespace mowing {
 
     private:
 
+        struct Tile {
+            double xmin, ymin, xmax, ymax;
+            // The uncovered regions within the tile. Built lazily on the thread processing the tile, such that
+            // the tiles do not share any reference-counted exact numbers.
+            Polygon_set_2 polygon_set;
+            bool initialized = false;
+        };
+
+        // Error of the approximated offsets, which is also subtracted from the radius to stay inside the coverage.
+        static constexpr double CIRCLE_SEGMENT_EPSILON = 1e-5;
+
         double radius;
         bool verbose;
+        bool circle_segment_fast_path;
+
+        // Contains the uncovered regions, but possibly more. Only valid if circle_segment_fast_path is set.
+        Circle_segment_polygon_2 circle_segment_base_polygon;
+        Circle_segment_polygon_set_2 circle_segment_polygon_set;
+        bool circle_segment_polygon_set_valid = false;
+
+        // The vertices of the input polygon, to build the tiles without sharing numbers.
+        std::vector<std::pair<double, double>> input_vertices;
+        std::vector<Tile> tiles;
+        unsigned num_threads = 1;
+
+        void initialize_tile(Tile &tile);
+        void compute_tiled_difference(std::vector<Linear_polygon> &tour_polygons);
+
+        struct PointHash {
+            std::size_t operator()(const Point &p) const;
+        };
 
+        std::vector<Point> chain_edges(std::vector<std::pair<Point, Point>> &edges);
         std::vector<Linear_polygon> extract_polygons(std::vector<Input_Point> &tour);
-        std::vector<Polygon_with_holes_2> compute_covered_polygon(std::vector<Input_Point> &tour, bool interpret_as_path);
+        std::vector<Linear_polygon> compute_tour_polygons(std::vector<Input_Point> &tour, bool interpret_as_path);
+        std::vector<Polygon_with_holes_2> compute_covered_polygon(std::vector<Linear_polygon> &tour_polygons);
+        bool is_coverage_certified(std::vector<Linear_polygon> &tour_polygons);
+        Circle_segment_polygon_with_holes_2 compute_inner_covered_polygon(Linear_polygon &tour_polygon);
+        Input_Linear_polygon convert_to_input_polygon(Linear_polygon &polygon);
 
         Point convert_input_point(const Input_Point &p);
 
@@ -33,6 +33,7 @@ namespace mowing {
             LowerBoundSolver::PointVector tour_after_tsp;
             bool optimal;
             double lower_bound;
+            std::unordered_map<std::string, std::string> cetsp_statistics;
         };
 
         struct solution {
@@ -52,9 +53,42 @@ namespace mowing {
 
         solution solve();
 
+        /**
+         * Places the witnesses of the followup iterations with several strategies, each combined with k-means and
+         * dispersion sparsification, and solves their CETSPs in parallel. Every CETSP yields a valid lower bound,
+         * so the witness set with the highest one is kept for the next iteration. The portfolio needs the exact
+         * uncovered regions, so it cannot be combined with the raster estimation.
+         * @param followup_strategies The FOLLOWUP_STRATEGY_* codes of the portfolio.
+         * @param num_threads The threads shared by all CETSP solvers, all hardware threads if 0.
+         * @throws std::invalid_argument If the raster estimation is enabled.
+         */
+        void enablePortfolio(const std::vector<int> &followup_strategies, unsigned num_threads = 0);
+
+        /**
+         * See MowingSolver::enableRasterEstimation.
+         * @throws std::invalid_argument If the portfolio is enabled, as it needs the exact uncovered regions.
+         */
+        void enableRasterEstimation(std::size_t resolution = 512) override;
+
     protected:
+        struct PortfolioMember {
+            int strategy;
+            std::unique_ptr<WitnessPlacementStrategy> placement;
+            std::unique_ptr<WitnessSparsification> sparsification;
+        };
+
+        std::vector<PortfolioMember> portfolio;
+        unsigned portfolio_threads = 0;
+
+        void getOptimalCETSPTour(lower_bound_solution &lb_solution, unsigned num_threads = 0);
 
-        void getOptimalCETSPTour(lower_bound_solution &lb_solution);
+        /**
+         * Computes a candidate for the uncovered regions with every member of the portfolio in parallel.
+         * @param uncovered The uncovered regions of the last tour.
+         * @param all_witnesses The witnesses so far, which are replaced by those of the best candidate.
+         * @return The candidate with the highest lower bound.
+         */
+        lower_bound_solution solvePortfolio(ConicPolygonVector &uncovered, PointVector &all_witnesses);
     };
 }
 
@@ -6,9 +6,12 @@
 #include <iostream>
 #include <fstream>
 #include <memory>
+#include <mutex>
 #include <random>
 #include <utility>
 #include <chrono>
+#include <string>
+#include <unordered_map>
 
 #include "utils/utils.hpp"
 #include "utils/tours.hpp"
@@ -16,6 +19,7 @@
 #include "utils/cgal.h"
 #include "cetsp/solver.h"
 #include "ExactOffsetCalculator.h"
+#include "RasterCoverageEstimator.h"
 #include "mowing/utils/mowing.h"
 #include "tsp/TSPSolver.h"
 #include "mowing/utils/cetsp_tours.h"
@@ -50,6 +54,7 @@ namespace mowing {
             PointVector tour_after_tsp;
             bool optimal{};
             double lower_bound{};
+            std::unordered_map<std::string, std::string> cetsp_statistics;
         };
 
         class MowingSolverCETSPException : public std::exception {
@@ -79,10 +84,39 @@ namespace mowing {
 
         double getLowerBound();
 
+        /**
+         * Computes the uncovered regions on tiles_per_axis^2 tiles in parallel, see ExactOffsetCalculator.
+         */
+        void setOffsetTiling(std::size_t tiles_per_axis, unsigned num_threads);
+
+        /**
+         * Certifies the coverage with circle-segment offsets before computing the exact conic offsets, see
+         * ExactOffsetCalculator. This only pays off if the tours are expected to cover the polygon. Otherwise, it
+         * adds a circle-segment difference to every computation of the uncovered regions. Resets the uncovered
+         * regions.
+         */
+        void enableCircleSegmentFastPath();
+
+        /**
+         * Estimates the uncovered regions on a grid first and places the witnesses of the followup strategy in the
+         * outlines of the uncovered cells. The exact offsets are only computed if the grid does not find any
+         * uncovered cell.
+         * @param resolution The number of cells along the longer side of the bounding box.
+         */
+        virtual void enableRasterEstimation(std::size_t resolution = 512);
+
+        /**
+         * Sets the number of threads of the CETSP solver and the k-means sparsification, e.g., if several solvers run
+         * in parallel.
+         * @param num_threads The number of threads, all hardware threads if 0.
+         */
+        void setCETSPThreads(unsigned num_threads);
+
     protected:
         Polygon_2 straight_line_polygon;
 
         std::unique_ptr<mowing::ExactOffsetCalculator> offset_calculator;
+        std::unique_ptr<mowing::RasterCoverageEstimator> raster_estimator;
 
         double radius;
         std::unique_ptr<WitnessPlacementStrategy> initial_strategy;
@@ -95,8 +129,16 @@ namespace mowing {
         int followup_strategy_code;
 
         Kernel::FT lower_bound;
+        // Guards the bounds, which may be updated by the subtours of several regions in parallel.
+        std::mutex bounds_mutex;
 
         double time;
+        unsigned cetsp_threads = 0;
+
+        // The configuration of the offset calculator, see initializeOffsetCalculator.
+        bool circle_segment_fast_path = false;
+        std::size_t offset_tiles_per_axis = 1;
+        unsigned offset_tiling_threads = 1;
 
         std::size_t max_witness_size;
         std::size_t max_witness_size_initial;
@@ -105,15 +147,25 @@ namespace mowing {
         void initializeOffsetCalculator();
 
         virtual ConicPolygonVector computeUncoveredRegions(PointVector &tour);
+        ConicPolygonVector computeUncoveredRegions(std::vector<PointVector> &added_subtours);
 
         static std::map<std::size_t, std::size_t>
         calculateWitnessCountsForRegions(ConicPolygonVector &polygons, std::size_t n);
 
+        static std::map<std::size_t, std::size_t>
+        calculateWitnessCountsForRegions(const std::vector<RasterCoverageEstimator::Region> &regions, std::size_t n);
+
+        static std::map<std::size_t, std::size_t>
+        calculateWitnessCountsForAreas(const std::vector<double> &areas, std::size_t n);
+
+        static std::unique_ptr<WitnessPlacementStrategy>
+        createFollowupStrategy(int followup_strategy, Polygon_2 &polygon, double radius);
+
         cetsp_extended_solution
-        calculateCETSPWithTSP(PointVector &witnesses, std::shared_ptr<Point> &start_point);
+        calculateCETSPWithTSP(PointVector &witnesses, std::shared_ptr<Point> &start_point, unsigned num_threads = 0);
 
         cetsp_extended_solution
-        calculateCETSPWithTSP(PointVector &witnesses);
+        calculateCETSPWithTSP(PointVector &witnesses, unsigned num_threads = 0);
 
         static double calculateTime(::utils::lvalue_or_rvalue<Clock::time_point> start,
                                     ::utils::lvalue_or_rvalue<Clock::time_point> end);
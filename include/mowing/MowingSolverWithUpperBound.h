@@ -50,21 +50,51 @@ namespace mowing {
         virtual solution solve() = 0;
         double getUpperBound();
 
+        /**
+         * Sets the number of threads computing the subtours of the uncovered regions. The CETSP solvers of these
+         * threads share the CETSP threads (see setCETSPThreads), such that the hardware is not oversubscribed.
+         */
+        void setRegionThreads(unsigned num_threads);
+
 
     protected:
         typedef std::pair<std::shared_ptr<Segment>, std::shared_ptr<std::pair<Point, Point>>> ShortestConnectingSegmentResult;
         std::function<void(solution &)> callback;
         Kernel::FT upper_bound;
-
-        void addTourForRegion(PointVector &tour, Conic_Polygon_with_holes_2 &region, PointVector &all_witnesses);
+        unsigned region_threads;
+
+        /**
+         * Computes a subtour for every region and inserts them into the tour. The subtours are computed in
+         * parallel, as the regions are independent until their subtours are inserted. The witnesses are still
+         * placed on the calling thread, since the conic regions must not be shared between threads. The subtours
+         * are inserted in the order of the regions afterward, such that the result does not depend on the threads.
+         * Every subtour starts at the point of the tour closest to its region before any subtour is inserted. A
+         * region can therefore not connect to the subtour of another region, even if it is closer, so the subtours
+         * may differ from inserting them one after another. The tour stays connected and covers the same regions.
+         * @param tour The tour to extend.
+         * @param regions The uncovered regions of the tour.
+         * @param all_witnesses The witnesses of all regions are appended for logging.
+         * @return The inserted (closed) subtour for every region, which is empty if it could not be inserted.
+         */
+        std::vector<PointVector> addToursForRegions(PointVector &tour, ConicPolygonVector &regions,
+                                                    PointVector &all_witnesses);
+
+        /**
+         * Inserts a subtour starting at a point on the tour. The start point is either a vertex of the tour or on
+         * one of its edges, which may have been split by subtours inserted before.
+         * @return The inserted (closed) subtour, which is empty if it could not be inserted.
+         */
+        static PointVector insertSubtour(PointVector &tour, PointVector &subtour, const Point &start_point);
 
         virtual ShortestConnectingSegmentResult getShortestConnectingSegment(PointVector &tour, Conic_Polygon_with_holes_2 &region);
 
-        virtual PointVector computeTourForConic(const ConicPolygon &P,
-                                        PointVector &all_witnesses,
-                                        std::shared_ptr<Point> &start_point);
+        virtual PointVector placeWitnessesForConic(const ConicPolygon &P, PointVector &all_witnesses);
 
-        PointVector calculateCETSPWithTSPAndUpdateBounds(PointVector &witnesses, std::shared_ptr<Point> &start_point);
+        /**
+         * @param num_threads The number of threads of the CETSP solver, the default of the solver if 0.
+         */
+        PointVector calculateCETSPWithTSPAndUpdateBounds(PointVector &witnesses, std::shared_ptr<Point> &start_point,
+                                                         unsigned num_threads = 0);
 
         virtual void updateUpperBound(PointVector &solution);
         Kernel::FT computeGap();
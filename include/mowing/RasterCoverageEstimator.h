@@ -0,0 +1,85 @@
+#ifndef MOWING_RASTER_COVERAGE_ESTIMATOR_H
+#define MOWING_RASTER_COVERAGE_ESTIMATOR_H
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+#include "mowing/utils/definitions.h"
+
+namespace mowing {
+
+    /**
+     * Estimates the coverage of a tour on a grid over the polygon, which is much faster than the exact offsets.
+     * A cell counts as covered if its center is within the radius of the tour. Thus, an uncovered cell is a
+     * point of the polygon that is certainly not covered, and a tour with uncovered cells is certainly not
+     * feasible. If no cell is uncovered, the tour is only probably feasible and the exact offsets have to verify
+     * it, as small regions may fall between the cell centers.
+     */
+    class RasterCoverageEstimator {
+    public:
+        typedef mowing::definitions::PointVector PointVector;
+
+        struct Region {
+            double area;
+            // The cell of the region with the largest (approximate) distance to the tour.
+            Point farthest_point;
+            double farthest_distance;
+            std::vector<std::size_t> cells;
+            // The (approximate) distance of every cell to the tour, in the order of cells.
+            std::vector<double> distances;
+        };
+
+        struct Estimate {
+            std::vector<Region> regions;
+            double uncovered_area;
+
+            [[nodiscard]] bool isProbablyCovered() const { return regions.empty(); }
+        };
+
+        /**
+         * @param polygon The polygon to be covered.
+         * @param radius The radius of the cutter.
+         * @param resolution The number of cells along the longer side of the bounding box.
+         */
+        RasterCoverageEstimator(Polygon_2 &polygon, double radius, std::size_t resolution = 512);
+
+        /**
+         * Rasterizes the r-thick stroke of the tour and returns the connected uncovered regions.
+         * @param tour The tour, which is closed unless interpret_as_path is set.
+         */
+        Estimate estimate(const PointVector &tour, bool interpret_as_path = false) const;
+
+        /**
+         * Places witnesses in an uncovered region by farthest-point sampling, starting with the cell farthest
+         * from the tour. All witnesses are uncovered points of the polygon.
+         * @param region A region of an estimate.
+         * @param n The number of witnesses (at most one per cell).
+         */
+        PointVector placeWitnesses(const Region &region, std::size_t n) const;
+
+        /**
+         * Traces the outer boundary of the cells of a region, such that the followup strategies can place their
+         * witnesses in it. The cells are only approximately inside the polygon, so the boundary may slightly
+         * leave it.
+         * @param region A region of an estimate.
+         * @return The counter-clockwise boundary without collinear vertices.
+         */
+        Polygon_2 outerBoundary(const Region &region) const;
+
+    private:
+        double radius;
+        double xmin, ymin, cell_size;
+        std::size_t width, height;
+
+        std::vector<uint8_t> inside; // cells with the center inside the polygon
+
+        [[nodiscard]] std::pair<double, double> center(std::size_t cell) const;
+
+        void rasterize_polygon(Polygon_2 &polygon);
+        void rasterize_segment(std::vector<uint8_t> &covered, double px, double py, double qx, double qy) const;
+        std::vector<double> compute_distances(const std::vector<uint8_t> &covered) const;
+    };
+}
+
+#endif
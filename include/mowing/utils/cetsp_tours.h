@@ -12,6 +12,16 @@ namespace mowing {
     namespace utils {
 
 
+        /**
+         * Removes consecutive duplicate points of a closed tour. This does not change the coverage of the tour.
+         */
+        template<typename PointType>
+        void remove_duplicate_points(std::vector<PointType> &tour);
+
+        /**
+         * Removes consecutive duplicate points and the middle points of collinear triples. The latter may remove
+         * the tip of a spike and thus change the coverage of the tour.
+         */
         template<typename PointType>
         void cleanup_tour(std::vector<PointType> &tour);
 
@@ -9,11 +9,19 @@ namespace mowing {
 
     class KMeansSparsification : public WitnessSparsification {
     public:
+        /**
+         * @param max_threads The threads assigning the points to the centroids of large instances, all hardware
+         * threads if 0. Should be 1 if the caller already runs in parallel.
+         */
+        explicit KMeansSparsification(unsigned max_threads = 0);
+
         std::optional<PointVector> sparsify(PointVector &witnesses,
                                             std::size_t n,
                                             const std::optional<ConicPolygon> &region,
                                             const std::optional<InputPolygon> &inputPolygon) override;
 
+    private:
+        unsigned max_threads;
     };
 }
 
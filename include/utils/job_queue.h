@@ -0,0 +1,65 @@
+#ifndef LAWN_MOWING_JOB_QUEUE_H
+#define LAWN_MOWING_JOB_QUEUE_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <boost/thread/thread.hpp>
+
+/**
+ * A simple job queue executed by a fixed number of worker threads.
+ */
+class JobQueue {
+public:
+    explicit JobQueue(unsigned num_workers) {
+        for (unsigned i = 0; i < num_workers; ++i) {
+            workers.create_thread([this]() { work(); });
+        }
+    }
+
+    void push(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        cv.notify_one();
+    }
+
+    /**
+     * Waits until all queued jobs are done and stops the workers.
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        cv.notify_all();
+        workers.join_all();
+    }
+
+private:
+    void work() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [this]() { return closed || !jobs.empty(); });
+                if (jobs.empty()) {
+                    return;
+                }
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> jobs;
+    bool closed = false;
+    boost::thread_group workers;
+};
+
+#endif //LAWN_MOWING_JOB_QUEUE_H
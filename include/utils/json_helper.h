@@ -28,6 +28,7 @@ json toJson(mowing::LowerBoundSolver::solution &solution) {
         lbSolutionJson["optimal"] = sol.optimal;
         lbSolutionJson["lower_bound"] = sol.lower_bound;
         lbSolutionJson["strategy"] = sol.strategy;
+        lbSolutionJson["cetsp_statistics"] = sol.cetsp_statistics;
 
         for (auto &p: sol.base_witnesses) {
             lbSolutionJson["base_witnesses"].emplace_back((json) {
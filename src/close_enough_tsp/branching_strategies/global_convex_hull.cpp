@@ -9,12 +9,10 @@ namespace cetsp {
 void GlobalConvexHullRule::setup(const Instance *instance_,
                                  std::shared_ptr<Node> &root,
                                  SolutionPool *solution_pool) {
-  std::cout << "Using GlobalConvexHullRule" << std::endl;
+  utils::log() << "Using GlobalConvexHullRule" << std::endl;
 
   instance = instance_;
-  order_values.resize(instance->size());
-  is_ordered.resize(instance->size(), false);
-  compute_weights(instance, root);
+  compute_weights(instance);
 
   if (!sequence_is_ch_ordered(root->get_fixed_sequence())) {
     for (auto i : root->get_fixed_sequence()) {
@@ -27,6 +25,9 @@ void GlobalConvexHullRule::setup(const Instance *instance_,
 
 bool GlobalConvexHullRule::is_ok(const std::vector<int> &seq,
                                  const Node &parent) {
+  if (disabled) {
+    return true;
+  }
   auto is_ok = sequence_is_ch_ordered(seq);
   return is_ok;
 }
@@ -117,20 +118,49 @@ GlobalConvexHullRule::get_circle_centers(const Instance &instance) const {
   return points;
 }
 
-void GlobalConvexHullRule::compute_weights(const Instance *instance,
-                                           std::shared_ptr<Node> &root) {
+bool GlobalConvexHullRule::on_instance_change() {
+  if (disabled) {
+    return false;
+  }
+  const auto n = static_cast<unsigned>(order_values.size());
+  const bool hull_changes =
+      std::any_of(instance->begin() + n, instance->end(),
+                  [this](const Circle &c) { return !hull->contains(c.center); });
+  if (hull_changes) {
+    // Previously excluded branches may be optimal now.
+    utils::log() << "GlobalConvexHullRule disabled by a circle extending the "
+                    "convex hull."
+                 << std::endl;
+    disabled = true;
+    return true;
+  }
+  // The hull and thus the order of the previous circles stay the same.
+  order_values.resize(instance->size());
+  is_ordered.resize(instance->size(), false);
+  for (unsigned i = n; i < instance->size(); ++i) {
+    compute_weight(i);
+  }
+  return false;
+}
+
+void GlobalConvexHullRule::compute_weights(const Instance *instance) {
   // Compute the weights used to check if the partial solution
   // obeys the convex hull.
-  auto points = get_circle_centers(*instance);
-  details::ConvexHullOrder vho(points);
+  hull.emplace(get_circle_centers(*instance));
+  order_values.assign(instance->size(), 0.0);
+  is_ordered.assign(instance->size(), false);
   for (unsigned i = 0; i < instance->size(); ++i) {
-    const auto weight = vho((*instance)[i]);
-    if (weight) {
-      is_ordered[i] = true;
-      order_values[i] = *weight;
-    } else {
-      is_ordered[i] = false;
-    }
+    compute_weight(i);
+  }
+}
+
+void GlobalConvexHullRule::compute_weight(unsigned i) {
+  const auto weight = (*hull)((*instance)[i]);
+  if (weight) {
+    is_ordered[i] = true;
+    order_values[i] = *weight;
+  } else {
+    is_ordered[i] = false;
   }
 }
 
@@ -8,10 +8,16 @@
 namespace cetsp {
 
 std::vector<ConvexHullLayer>
-ConvexHullLayer::calc_ch_layers(const Instance &instance) {
-  std::vector<ConvexHullLayer> layers;
+ConvexHullLayer::calc_ch_layers(const Instance &instance,
+                                std::vector<ConvexHullLayer> layers) {
   // handled[circle_idx] = the circle is included in the already created layers
   std::vector<bool> handled(instance.size(), false);
+  for (auto &layer : layers) {
+    layer.global_to_hull_map.resize(instance.size());
+    for (unsigned int global_idx : layer.hull_to_global_map) {
+      handled[global_idx] = true;
+    }
+  }
 
   for (unsigned int unhandled_num;;) {
     unhandled_num = std::count(handled.begin(), handled.end(), false);
@@ -64,7 +70,8 @@ ConvexHullLayer::calc_ch_layers(const Instance &instance) {
       layer.hull_to_global_map.push_back(global_idx);
       handled[global_idx] = true;
     }
-    layers.push_back(layer);
+    layer.hull = std::move(vho);
+    layers.push_back(std::move(layer));
   }
   return layers;
 }
@@ -72,16 +79,55 @@ ConvexHullLayer::calc_ch_layers(const Instance &instance) {
 void LayeredConvexHullRule::setup(const Instance *instance_,
                                   std::shared_ptr<Node> &root,
                                   SolutionPool *solution_pool) {
-  std::cout << "Using LayeredConvexHullRule" << std::endl;
+  utils::log() << "Using LayeredConvexHullRule" << std::endl;
 
   instance = instance_;
   layers = ConvexHullLayer::calc_ch_layers(*instance);
+  num_circles = instance->size();
 
   if (!is_ok(root->get_fixed_sequence(), 0)) {
     throw std::invalid_argument("Root does not obey the layered convex hull.");
   }
 }
 
+bool LayeredConvexHullRule::on_instance_change() {
+  if (disabled) {
+    return false;
+  }
+  // The layers outside of the first layer touched by a new circle stay the
+  // same. A circle that intersects a layer without changing its hull joins
+  // it, which does not affect the deeper layers either.
+  auto first_rebuilt = layers.size();
+  bool hull_changed = false;
+  for (auto i = num_circles; i < instance->size(); ++i) {
+    const auto &circle = (*instance)[i];
+    for (unsigned int k = 0; k < layers.size(); ++k) {
+      if (!layers[k].hull->contains(circle.center)) {
+        hull_changed = true;
+        first_rebuilt = std::min<size_t>(first_rebuilt, k);
+        break;
+      }
+      if ((*layers[k].hull)(circle)) {
+        first_rebuilt = std::min<size_t>(first_rebuilt, k);
+        break;
+      }
+    }
+  }
+  if (hull_changed) {
+    // Previously excluded branches may be optimal now.
+    utils::log() << "LayeredConvexHullRule disabled by a circle changing a "
+                    "convex hull."
+                 << std::endl;
+    disabled = true;
+    layers.clear();
+    return true;
+  }
+  layers.resize(first_rebuilt);
+  layers = ConvexHullLayer::calc_ch_layers(*instance, std::move(layers));
+  num_circles = instance->size();
+  return false;
+}
+
 class HullVisitor {
 public:
   HullVisitor(const ConvexHullLayer &layer, const std::vector<int> &seq) {
@@ -195,6 +241,9 @@ private:
 
 bool LayeredConvexHullRule::is_ok(const std::vector<int> &seq,
                                   const Node &parent) {
+  if (disabled) {
+    return true;
+  }
   return is_ok(seq);
 }
 
@@ -3,6 +3,7 @@
 //
 #include "cetsp/strategies/branching_strategy.h"
 #include <boost/thread/thread.hpp>
+#include <utility>
 // #include <execution>
 namespace cetsp {
 
@@ -18,6 +19,7 @@ namespace cetsp {
 std::optional<int>
 get_index_of_most_distanced_circle(const PartialSequenceSolution &solution,
                                    const Instance &instance) {
+  CETSP_PROFILE_SCOPE(FEASIBILITY);
   const int n = static_cast<int>(instance.size());
   std::vector<double> distances(n);
   for (int i = 0; i < n; ++i) {
@@ -37,44 +39,72 @@ get_index_of_most_distanced_circle(const PartialSequenceSolution &solution,
 
 void distributed_child_evaluation(std::vector<std::shared_ptr<Node>> &children,
                                   const bool simplify,
-                                  const size_t num_threads) {
+                                  const size_t num_threads,
+                                  const double cutoff =
+                                      std::numeric_limits<double>::infinity()) {
   // Parallelize the computation of the relaxed solutions for the children
   // using a simple modulo on the number of threads. This is fine as we write
   // on separate heap memory for all children.
-  boost::thread_group tg;
-  if (num_threads <= 1) { // Without threading overhead.
-    for (auto i = 0; i < children.size(); i += 1) {
+  // If a finite cutoff is given, the children can be cut off.
+  const bool use_cutoff = cutoff < std::numeric_limits<double>::infinity();
+  auto evaluate = [&children, simplify, use_cutoff, cutoff](size_t offset,
+                                                           size_t step) {
+    if (use_cutoff) {
+      for (auto i = offset; i < children.size(); i += step) {
+        if (!children[i]->trigger_lazy_evaluation(cutoff) && simplify) {
+          children[i]->simplify();
+        }
+      }
+      return;
+    }
+    for (auto i = offset; i < children.size(); i += step) {
       children[i]->trigger_lazy_evaluation();
       if (simplify) {
         children[i]->simplify();
       }
     }
+  };
+  boost::thread_group tg;
+#ifdef CETSP_PROFILING
+  // The time each thread waits for the slowest one is counted as idle time.
+  std::vector<uint64_t> finished_ns(std::min(num_threads, children.size()));
+  auto *profiler = details::Profiler::current();
+#endif
+  if (num_threads <= 1) { // Without threading overhead.
+    evaluate(0, 1);
   } else {
     for (unsigned int offset = 0;
          offset < std::min(num_threads, children.size()); ++offset) {
-      tg.create_thread([=, &children]() {
-        for (auto i = offset; i < children.size(); i += num_threads) {
-          children[i]->trigger_lazy_evaluation();
-          if (simplify) {
-            children[i]->simplify();
-          }
-        }
+      tg.create_thread([&, offset]() {
+#ifdef CETSP_PROFILING
+        // record the SOCs of the thread to the profiler of the BnB.
+        details::Profiler::Activation profiling(profiler);
+#endif
+        evaluate(offset, num_threads);
+#ifdef CETSP_PROFILING
+        finished_ns[offset] = details::profiling_clock_ns(CLOCK_MONOTONIC);
+#endif
       });
     }
   }
   tg.join_all(); // Wait for all threads to finish, so we are in a consistent
                  // state.
+#ifdef CETSP_PROFILING
+  if (num_threads > 1 && profiler != nullptr) {
+    const auto joined_ns = details::profiling_clock_ns(CLOCK_MONOTONIC);
+    for (const auto t : finished_ns) {
+      profiler->record(details::ProfilingPhase::THREAD_IDLE, joined_ns - t, 0);
+    }
+  }
+#endif
 }
 
-bool CircleBranching::branch(Node &node) {
-  const auto c = get_branching_circle(node);
-  if (!c) {
-    return false;
-  }
+std::vector<std::shared_ptr<Node>>
+CircleBranching::create_children(Node &node, int c) {
   std::vector<std::shared_ptr<Node>> children;
   std::vector<int> seq;
   seq = node.get_fixed_sequence();
-  seq.push_back(*c);
+  seq.push_back(c);
   if (instance->is_path()) {
     // for path, this position may not be symmetric and has to be added.
     if (is_sequence_ok(seq, node)) {
@@ -83,16 +113,148 @@ bool CircleBranching::branch(Node &node) {
   }
   for (int i = seq.size() - 1; i > 0; --i) {
     seq[i] = seq[i - 1];
-    seq[i - 1] = *c;
+    seq[i - 1] = c;
     if (is_sequence_ok(seq, node)) {
       children.push_back(std::make_shared<Node>(seq, instance, &node));
     }
   }
-  distributed_child_evaluation(children, simplify, num_threads);
+  return children;
+}
+
+void CircleBranching::update_rules() {
+  if (instance->revision == instance_revision) {
+    return;
+  }
+  instance_revision = instance->revision;
+  for (auto &rule : rules) {
+    if (rule->on_instance_change()) {
+      restart_required = true;
+    }
+  }
+}
+
+bool CircleBranching::requires_restart() {
+  update_rules();
+  return std::exchange(restart_required, false);
+}
+
+double CircleBranching::get_cutoff() const {
+  if (cutoff_gap && solution_pool != nullptr && !solution_pool->empty()) {
+    return (1.0 - *cutoff_gap) * solution_pool->get_upper_bound();
+  }
+  return std::numeric_limits<double>::infinity();
+}
+
+bool CircleBranching::branch(Node &node) {
+  const auto c = get_branching_circle(node);
+  if (!c) {
+    return false;
+  }
+  auto children = create_children(node, *c);
+  distributed_child_evaluation(children, simplify, num_threads, get_cutoff());
   node.branch(children);
   return true;
 }
 
+bool StrongBranchingFarthestCircle::branch(Node &node) {
+  if (node.depth() >= max_probe_depth || num_candidates == 1) {
+    return CircleBranching::branch(node);
+  }
+  // The uncovered circles with the largest distances are the candidates.
+  const auto &solution = node.get_relaxed_solution();
+  std::vector<std::pair<double, int>> uncovered;
+  for (int i = 0; i < static_cast<int>(instance->size()); ++i) {
+    if (!solution.covers(i)) {
+      uncovered.emplace_back(solution.distance(i), i);
+    }
+  }
+  if (uncovered.empty()) {
+    return false;
+  }
+  const auto k = std::min(num_candidates, uncovered.size());
+  std::partial_sort(uncovered.begin(), uncovered.begin() + k, uncovered.end(),
+                    std::greater<>());
+  // Evaluate the children of all candidates together to use all threads.
+  std::vector<std::vector<std::shared_ptr<Node>>> probes;
+  std::vector<std::shared_ptr<Node>> all_children;
+  for (size_t j = 0; j < k; ++j) {
+    probes.push_back(create_children(node, uncovered[j].second));
+    all_children.insert(all_children.end(), probes.back().begin(),
+                        probes.back().end());
+  }
+  distributed_child_evaluation(all_children, simplify, num_threads,
+                               get_cutoff());
+  // Branch on the candidate whose weakest child has the highest bound. The
+  // evaluated children are used directly.
+  size_t best = 0;
+  double best_bound = -std::numeric_limits<double>::infinity();
+  for (size_t j = 0; j < k; ++j) {
+    double bound = std::numeric_limits<double>::infinity();
+    for (auto &child : probes[j]) {
+      bound = std::min(bound, child->get_lower_bound());
+    }
+    if (bound > best_bound) {
+      best_bound = bound;
+      best = j;
+    }
+  }
+  node.branch(probes[best]);
+  return true;
+}
+
+bool IntersectionBranching::branch(Node &node) {
+  if (instance->is_path()) { // intersections are only computed for tours
+    return FarthestCircle::branch(node);
+  }
+  const auto c = get_branching_circle(node);
+  if (!c) {
+    return false;
+  }
+  auto children = create_children(node, *c);
+  auto uncrossed_children = create_uncrossed_children(node);
+  children.insert(children.end(), uncrossed_children.begin(),
+                  uncrossed_children.end());
+  distributed_child_evaluation(children, simplify, num_threads, get_cutoff());
+  node.branch(children);
+  return true;
+}
+
+std::vector<std::shared_ptr<Node>>
+IntersectionBranching::create_uncrossed_children(Node &node) {
+  // Relative length by which a 2-opt move has to shorten the trajectory. The
+  // relaxed solution of the child is at most as long as the shortened
+  // trajectory, so the moves cannot cycle, even for inexact SOCs.
+  constexpr double MIN_IMPROVEMENT = 1e-3;
+  std::vector<std::shared_ptr<Node>> children;
+  const auto intersections = node.get_intersections();
+  if (intersections.empty()) {
+    return children;
+  }
+  const auto &sequence = node.get_fixed_sequence();
+  const auto length = node.get_relaxed_solution().get_trajectory().length();
+  for (const auto &intersection : intersections) {
+    if (intersection.i > intersection.j) {
+      continue; // every crossing is reported for both edges
+    }
+    // Reconnecting p1p2 and p3p4 to p1p3 and p2p4 reverses the sequence
+    // between the two edges.
+    const auto improvement = intersection.p1.dist(intersection.p2) +
+                             intersection.p3.dist(intersection.p4) -
+                             intersection.p1.dist(intersection.p3) -
+                             intersection.p2.dist(intersection.p4);
+    if (improvement <= MIN_IMPROVEMENT * length) {
+      continue;
+    }
+    auto seq = sequence;
+    std::reverse(seq.begin() + intersection.i + 1,
+                 seq.begin() + intersection.j + 1);
+    if (is_sequence_ok(seq, node)) {
+      children.push_back(std::make_shared<Node>(seq, instance, &node));
+    }
+  }
+  return children;
+}
+
 std::optional<int> FarthestCircle::get_branching_circle(Node &node) {
   const auto c = get_index_of_most_distanced_circle(node.get_relaxed_solution(),
                                                     *instance);
@@ -55,6 +55,17 @@ std::optional<double> ConvexHullOrder::operator()(const Circle &circle) {
   return weight + std::sqrt(squared_distance(r1, p));
 }
 
+bool ConvexHullOrder::contains(const Point &point) const {
+  if (segments.size() < 3) {
+    return false;
+  }
+  const Point_2 p{point.x, point.y};
+  // the segments are counter-clockwise, so the inside is to their left.
+  return std::none_of(segments.begin(), segments.end(), [&p](const auto &s) {
+    return CGAL::orientation(s.source(), s.target(), p) == CGAL::RIGHT_TURN;
+  });
+}
+
 std::vector<Segment_2> ConvexHullOrder::compute_convex_hull_segments(
     const std::vector<Point> &points) const {
   /**
@@ -0,0 +1,686 @@
+//
+// Coordinator/worker implementation of the distributed BnB.
+//
+#include "cetsp/distributed.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <netdb.h>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+namespace cetsp {
+namespace details {
+
+LineConnection::~LineConnection() { ::close(fd); }
+
+void LineConnection::close() {
+  ::shutdown(fd, SHUT_RDWR);
+  closed = true;
+}
+
+void LineConnection::send(const std::string &line) {
+  if (closed) {
+    return;
+  }
+  const auto message = line + "\n";
+  size_t sent = 0;
+  while (sent < message.size()) {
+    const auto n = ::send(fd, message.data() + sent, message.size() - sent,
+                          MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      closed = true;
+      return;
+    }
+    sent += static_cast<size_t>(n);
+  }
+}
+
+std::optional<std::string> LineConnection::pop_line() {
+  const auto pos = buffer.find('\n');
+  if (pos == std::string::npos) {
+    return {};
+  }
+  auto line = buffer.substr(0, pos);
+  buffer.erase(0, pos + 1);
+  return line;
+}
+
+std::optional<std::string> LineConnection::receive(int timeout_ms) {
+  while (true) {
+    if (auto line = pop_line()) {
+      return line;
+    }
+    if (closed) {
+      return {};
+    }
+    pollfd pfd{fd, POLLIN, 0};
+    const auto ready = ::poll(&pfd, 1, timeout_ms);
+    if (ready < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ready <= 0) {
+      return {}; // timeout
+    }
+    char chunk[4096];
+    const auto n = ::recv(fd, chunk, sizeof(chunk), 0);
+    if (n <= 0) {
+      closed = true;
+      return {};
+    }
+    buffer.append(chunk, static_cast<size_t>(n));
+  }
+}
+
+/**
+ * Splits `tcp:<host>:<port>` into host and port.
+ */
+static std::pair<std::string, std::string>
+split_tcp_address(const std::string &address) {
+  const auto rest = address.substr(4);
+  const auto colon = rest.rfind(':');
+  if (colon == std::string::npos) {
+    throw std::invalid_argument("Invalid tcp address " + address);
+  }
+  return {rest.substr(0, colon), rest.substr(colon + 1)};
+}
+
+static sockaddr_un unix_socket_address(const std::string &address) {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  const auto path = address.substr(5);
+  if (path.size() >= sizeof(addr.sun_path)) {
+    throw std::invalid_argument("Unix socket path too long: " + path);
+  }
+  std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  return addr;
+}
+
+static bool starts_with(const std::string &s, const std::string &prefix) {
+  return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+int listen_on(const std::string &address) {
+  int fd = -1;
+  if (starts_with(address, "unix:")) {
+    const auto addr = unix_socket_address(address);
+    ::unlink(addr.sun_path);
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::bind(fd, reinterpret_cast<const sockaddr *>(&addr),
+                         sizeof(addr)) != 0) {
+      throw std::runtime_error("Could not bind to " + address + ": " +
+                               std::strerror(errno));
+    }
+  } else if (starts_with(address, "tcp:")) {
+    const auto [host, port] = split_tcp_address(address);
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo *result = nullptr;
+    if (::getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(),
+                      &hints, &result) != 0) {
+      throw std::runtime_error("Could not resolve " + address);
+    }
+    for (auto *ai = result; ai != nullptr; ai = ai->ai_next) {
+      fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+      if (fd < 0) {
+        continue;
+      }
+      int yes = 1;
+      ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+      if (::bind(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+        break;
+      }
+      ::close(fd);
+      fd = -1;
+    }
+    ::freeaddrinfo(result);
+    if (fd < 0) {
+      throw std::runtime_error("Could not bind to " + address);
+    }
+  } else {
+    throw std::invalid_argument("Unknown address type: " + address);
+  }
+  if (::listen(fd, 64) != 0) {
+    throw std::runtime_error("Could not listen on " + address + ": " +
+                             std::strerror(errno));
+  }
+  return fd;
+}
+
+static int try_connect(const std::string &address) {
+  if (starts_with(address, "unix:")) {
+    const auto addr = unix_socket_address(address);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && ::connect(fd, reinterpret_cast<const sockaddr *>(&addr),
+                             sizeof(addr)) == 0) {
+      return fd;
+    }
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    return -1;
+  }
+  if (starts_with(address, "tcp:")) {
+    const auto [host, port] = split_tcp_address(address);
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *result = nullptr;
+    if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0) {
+      return -1;
+    }
+    int fd = -1;
+    for (auto *ai = result; ai != nullptr; ai = ai->ai_next) {
+      fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+      if (fd >= 0 && ::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+        break;
+      }
+      if (fd >= 0) {
+        ::close(fd);
+      }
+      fd = -1;
+    }
+    ::freeaddrinfo(result);
+    return fd;
+  }
+  throw std::invalid_argument("Unknown address type: " + address);
+}
+
+int connect_to(const std::string &address) {
+  constexpr int MAX_ATTEMPTS = 50;
+  for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+    const auto fd = try_connect(address);
+    if (fd >= 0) {
+      return fd;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  throw std::runtime_error("Could not connect to " + address);
+}
+
+static std::string serialize_sequence(const std::vector<int> &sequence) {
+  std::ostringstream out;
+  out << sequence.size();
+  for (const auto i : sequence) {
+    out << " " << i;
+  }
+  return out.str();
+}
+
+/**
+ * Parses a sequence of at most `max_length` indices, such that a malformed
+ * message cannot allocate without limit.
+ */
+static std::vector<int> parse_sequence(std::istream &in, size_t max_length) {
+  size_t k = 0;
+  in >> k;
+  if (!in || k > max_length) {
+    throw std::invalid_argument("Malformed sequence in message.");
+  }
+  std::vector<int> sequence(k);
+  for (auto &i : sequence) {
+    in >> i;
+  }
+  if (!in) {
+    throw std::invalid_argument("Malformed sequence in message.");
+  }
+  return sequence;
+}
+
+/**
+ * Returns the solution for the sequence, if it is feasible.
+ */
+static std::optional<Solution>
+solution_from_sequence(const Instance *instance,
+                       const std::vector<int> &sequence) {
+  for (const auto i : sequence) {
+    if (i < 0 || i >= static_cast<int>(instance->size())) {
+      return {};
+    }
+  }
+  PartialSequenceSolution solution(instance, sequence);
+  if (!solution.is_feasible()) {
+    return {};
+  }
+  return Solution(std::move(solution));
+}
+
+/**
+ * Reports new solutions and bounds of a worker's local BnB and applies the
+ * messages of the coordinator.
+ */
+class WorkerCallback : public B2BNodeCallback {
+public:
+  WorkerCallback(LineConnection &connection, int subproblem_id,
+                 BranchAndBoundAlgorithm &bnb, double &reported_ub,
+                 bool &stopped)
+      : connection{connection}, subproblem_id{subproblem_id}, bnb{bnb},
+        reported_ub{reported_ub}, stopped{stopped} {}
+
+  void on_leaving_node(EventContext &context) override {
+    constexpr int LB_REPORT_INTERVAL = 50;
+    if (context.get_upper_bound() < reported_ub) {
+      auto solution = context.get_best_solution();
+      connection.send("SOL " + serialize_sequence(solution->get_sequence()));
+      reported_ub = context.get_upper_bound();
+    }
+    if (context.num_iterations % LB_REPORT_INTERVAL == 0) {
+      const auto lb = context.get_lower_bound();
+      if (lb > reported_lb) {
+        std::ostringstream msg;
+        msg.precision(17);
+        msg << "LB " << subproblem_id << " " << lb;
+        connection.send(msg.str());
+        reported_lb = lb;
+      }
+    }
+    while (auto line = connection.receive(0)) {
+      std::istringstream in(*line);
+      std::string type;
+      in >> type;
+      if (type == "UB") {
+        auto solution = solution_from_sequence(
+            context.instance, parse_sequence(in, context.instance->size()));
+        if (solution) {
+          context.add_solution(*solution);
+          reported_ub = std::min(reported_ub, context.get_upper_bound());
+        }
+      } else if (type == "STOP") {
+        stopped = true;
+      }
+    }
+    if (stopped || connection.is_closed()) {
+      bnb.stop();
+    }
+  }
+
+private:
+  LineConnection &connection;
+  int subproblem_id;
+  BranchAndBoundAlgorithm &bnb;
+  double &reported_ub;
+  double reported_lb = 0.0;
+  bool &stopped;
+};
+} // namespace details
+
+DistributedCoordinator::DistributedCoordinator(
+    Instance *instance, std::shared_ptr<Node> root_,
+    BranchingStrategy &branching_strategy, std::string address)
+    : instance{instance}, root{std::move(root_)},
+      branching_strategy{branching_strategy}, address{std::move(address)} {
+  if (instance->is_path()) {
+    throw std::invalid_argument("Distributed BnB only supports tours.");
+  }
+  branching_strategy.setup(instance, root, &solution_pool);
+}
+
+double DistributedCoordinator::get_lower_bound() const {
+  auto lb = explored_lower_bound;
+  if (pending.empty() && assigned.empty()) {
+    // Everything explored, no solution can be better than the incumbent.
+    return std::min(lb, get_upper_bound());
+  }
+  for (const auto &subproblem : pending) {
+    lb = std::min(lb, subproblem.lower_bound);
+  }
+  for (const auto &[id, subproblem] : assigned) {
+    lb = std::min(lb, subproblem.lower_bound);
+  }
+  return lb;
+}
+
+void DistributedCoordinator::expand_frontier(size_t frontier_size,
+                                             double gap) {
+  // Best-first expansion of the top of the tree.
+  std::vector<std::shared_ptr<Node>> open{root};
+  auto close = [this](double lb) {
+    explored_lower_bound = std::min(explored_lower_bound, lb);
+  };
+  while (!open.empty() && open.size() < frontier_size) {
+    auto best = std::min_element(open.begin(), open.end(),
+                                 [](const auto &a, const auto &b) {
+                                   return a->get_lower_bound() <
+                                          b->get_lower_bound();
+                                 });
+    auto node = *best;
+    open.erase(best);
+    if (node->is_pruned()) {
+      close(node->get_lower_bound());
+      continue;
+    }
+    if (node->is_feasible()) {
+      solution_pool.add_solution(node->get_relaxed_solution());
+      close(node->get_lower_bound());
+      continue;
+    }
+    if (node->get_lower_bound() >=
+            (1.0 - gap) * solution_pool.get_upper_bound() ||
+        !branching_strategy.branch(*node)) {
+      close(node->get_lower_bound());
+      continue;
+    }
+    for (auto &child : node->get_children()) {
+      if (child->is_pruned()) { // e.g., by an objective cutoff
+        close(child->get_lower_bound());
+      } else {
+        open.push_back(child);
+      }
+    }
+  }
+  for (auto &node : open) {
+    pending.push_back({node->get_fixed_sequence(), node->get_lower_bound()});
+  }
+}
+
+void DistributedCoordinator::accept_worker(int listen_fd) {
+  const auto fd = ::accept(listen_fd, nullptr, nullptr);
+  if (fd < 0) {
+    return;
+  }
+  auto connection = std::make_unique<details::LineConnection>(fd);
+  std::ostringstream msg;
+  msg.precision(17);
+  msg << "INSTANCE " << instance->size();
+  for (const auto &circle : *instance) {
+    msg << " " << circle.center.x << " " << circle.center.y << " "
+        << circle.radius;
+  }
+  connection->send(msg.str());
+  if (!solution_pool.empty()) {
+    connection->send(
+        "UB " +
+        details::serialize_sequence(get_solution()->get_sequence()));
+  }
+  workers.push_back(std::move(connection));
+  ++num_workers_connected;
+}
+
+void DistributedCoordinator::assign_subproblem(size_t worker) {
+  if (pending.empty()) {
+    // The worker waits until a subproblem is requeued or all are done.
+    idle_workers.insert(worker);
+    return;
+  }
+  idle_workers.erase(worker);
+  auto best = std::min_element(pending.begin(), pending.end(),
+                               [](const auto &a, const auto &b) {
+                                 return a.lower_bound < b.lower_bound;
+                               });
+  auto subproblem = std::move(*best);
+  pending.erase(best);
+  subproblem.worker = worker;
+  const auto id = next_subproblem_id++;
+  std::ostringstream msg;
+  msg.precision(17);
+  msg << "SUB " << id << " " << subproblem.lower_bound << " "
+      << details::serialize_sequence(subproblem.sequence);
+  workers[worker]->send(msg.str());
+  assigned.emplace(id, std::move(subproblem));
+}
+
+void DistributedCoordinator::requeue_subproblems_of(size_t worker) {
+  for (auto it = assigned.begin(); it != assigned.end();) {
+    if (it->second.worker == worker) {
+      pending.push_back(std::move(it->second));
+      it = assigned.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  assign_to_idle_workers();
+}
+
+void DistributedCoordinator::assign_to_idle_workers() {
+  while (!pending.empty() && !idle_workers.empty()) {
+    assign_subproblem(*idle_workers.begin());
+  }
+}
+
+void DistributedCoordinator::drop_worker(size_t worker) {
+  workers[worker].reset(); // keep the indices of the other workers
+  idle_workers.erase(worker);
+  requeue_subproblems_of(worker);
+}
+
+void DistributedCoordinator::broadcast_upper_bound() {
+  const auto message =
+      "UB " + details::serialize_sequence(get_solution()->get_sequence());
+  for (auto &worker : workers) {
+    if (worker) {
+      worker->send(message);
+    }
+  }
+}
+
+bool DistributedCoordinator::handle_message(size_t worker,
+                                            const std::string &line) {
+  std::istringstream in(line);
+  std::string type;
+  in >> type;
+  if (type == "READY") {
+    assign_subproblem(worker);
+  } else if (type == "SOL") {
+    ++num_solutions_received;
+    auto solution = details::solution_from_sequence(
+        instance, details::parse_sequence(in, instance->size()));
+    if (solution) {
+      const auto ub = get_upper_bound();
+      solution_pool.add_solution(*solution);
+      if (get_upper_bound() < ub) {
+        broadcast_upper_bound();
+      }
+    }
+  } else if (type == "LB" || type == "DONE") {
+    int id = -1;
+    double lb = 0;
+    in >> id >> lb;
+    if (!in) {
+      throw std::invalid_argument("Malformed bound in message.");
+    }
+    auto it = assigned.find(id);
+    if (it == assigned.end()) {
+      return true;
+    }
+    if (type == "LB") {
+      it->second.lower_bound = std::max(it->second.lower_bound, lb);
+    } else {
+      explored_lower_bound =
+          std::min(explored_lower_bound, std::max(it->second.lower_bound, lb));
+      assigned.erase(it);
+      ++num_subproblems_solved;
+    }
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void DistributedCoordinator::optimize(int timelimit_s, double gap,
+                                      size_t frontier_size, bool verbose) {
+  utils::Timer timer(timelimit_s);
+  const auto listen_fd = details::listen_on(address);
+  expand_frontier(frontier_size, gap);
+  if (verbose) {
+    std::cout << "Distributing " << pending.size() << " subproblems via "
+              << address << std::endl;
+    std::cout << "LB\t|\tUB\t|\tOpen\t|\tTime" << std::endl;
+  }
+  double last_print = 0;
+  while (true) {
+    const auto lb = get_lower_bound();
+    const auto ub = get_upper_bound();
+    if (verbose && timer.seconds() - last_print >= 1.0) {
+      std::cout << lb << "\t|\t" << ub << "\t|\t"
+                << pending.size() + assigned.size() << "\t|\t"
+                << timer.seconds() << "s" << std::endl;
+      last_print = timer.seconds();
+    }
+    if (ub <= (1 + gap) * lb || (pending.empty() && assigned.empty())) {
+      break;
+    }
+    if (timer.timeout()) {
+      if (verbose) {
+        std::cout << "Timeout." << std::endl;
+      }
+      break;
+    }
+    std::vector<pollfd> fds;
+    fds.push_back({listen_fd, POLLIN, 0});
+    for (auto &worker : workers) {
+      fds.push_back({worker ? worker->get_fd() : -1, POLLIN, 0});
+    }
+    if (::poll(fds.data(), fds.size(), 100) < 0 && errno != EINTR) {
+      throw std::runtime_error(std::string("poll failed: ") +
+                               std::strerror(errno));
+    }
+    if (fds[0].revents & POLLIN) {
+      accept_worker(listen_fd);
+    }
+    for (size_t w = 0; w + 1 < fds.size(); ++w) {
+      if (!workers[w] || fds[w + 1].revents == 0) {
+        continue;
+      }
+      while (auto line = workers[w]->receive(0)) {
+        bool known = false;
+        try {
+          known = handle_message(w, *line);
+        } catch (const std::invalid_argument &) {
+          // malformed, treated like an unknown message
+        }
+        if (!known) {
+          std::cerr << "Dropping worker " << w
+                    << " after unknown or malformed message: " << *line
+                    << std::endl;
+          workers[w]->close();
+          break;
+        }
+      }
+      if (workers[w]->is_closed()) {
+        drop_worker(w);
+      }
+    }
+  }
+  for (auto &worker : workers) {
+    if (worker) {
+      worker->send("STOP");
+    }
+  }
+  workers.clear();
+  ::close(listen_fd);
+  if (verbose) {
+    std::cout << "---------------" << std::endl
+              << get_lower_bound() << "\t|\t" << get_upper_bound()
+              << std::endl;
+  }
+}
+
+std::unordered_map<std::string, std::string>
+DistributedCoordinator::get_statistics() const {
+  std::unordered_map<std::string, std::string> stats;
+  stats["num_workers_connected"] = std::to_string(num_workers_connected);
+  stats["num_subproblems"] = std::to_string(next_subproblem_id);
+  stats["num_subproblems_solved"] = std::to_string(num_subproblems_solved);
+  stats["num_solutions_received"] = std::to_string(num_solutions_received);
+  return stats;
+}
+
+int DistributedWorker::run(int timelimit_s, double gap, bool verbose) {
+  utils::Timer timer(timelimit_s);
+  details::LineConnection connection(details::connect_to(address));
+  auto header = connection.receive(-1);
+  if (!header) {
+    throw std::runtime_error("Coordinator closed connection.");
+  }
+  // Rebuild the instance exactly, without reordering or removing circles,
+  // such that the indices of the sequences match.
+  Instance instance;
+  {
+    std::istringstream in(*header);
+    std::string type;
+    size_t n = 0;
+    in >> type >> n;
+    if (type != "INSTANCE") {
+      throw std::invalid_argument("Expected instance, got: " + *header);
+    }
+    for (size_t i = 0; i < n; ++i) {
+      double x, y, r;
+      in >> x >> y >> r;
+      instance.push_back(Circle(Point(x, y), r));
+    }
+  }
+  auto solution_pool = std::make_shared<SolutionPool>();
+  double reported_ub = std::numeric_limits<double>::infinity();
+  bool stopped = false;
+  int num_solved = 0;
+  while (!stopped && !connection.is_closed()) {
+    connection.send("READY");
+    // Apply incoming incumbents until the subproblem arrives.
+    std::optional<std::string> line;
+    std::istringstream in;
+    std::string type;
+    while ((line = connection.receive(-1))) {
+      in = std::istringstream(*line);
+      in >> type;
+      if (type != "UB") {
+        break;
+      }
+      auto solution = details::solution_from_sequence(
+          &instance, details::parse_sequence(in, instance.size()));
+      if (solution) {
+        solution_pool->add_solution(*solution);
+        reported_ub = std::min(reported_ub, solution_pool->get_upper_bound());
+      }
+    }
+    if (!line || type == "STOP") {
+      break;
+    }
+    if (type != "SUB") {
+      throw std::invalid_argument("Unexpected message: " + *line);
+    }
+    int id = -1;
+    double lb = 0;
+    in >> id >> lb;
+    auto sequence = details::parse_sequence(in, instance.size());
+    auto root = std::make_shared<Node>(sequence, &instance);
+    root->add_lower_bound(lb);
+    auto [branching_strategy, search_strategy] = strategy_factory();
+    BranchAndBoundAlgorithm bnb(&instance, root, *branching_strategy,
+                                *search_strategy, solution_pool);
+    bnb.add_node_callback(std::make_unique<details::WorkerCallback>(
+        connection, id, bnb, reported_ub, stopped));
+    const auto remaining =
+        static_cast<int>(timer.time_limit - timer.seconds());
+    bnb.optimize(std::max(remaining, 0), gap, verbose);
+    if (stopped) {
+      break;
+    }
+    // Report solutions found in the last iteration.
+    if (solution_pool->get_upper_bound() < reported_ub) {
+      connection.send("SOL " + details::serialize_sequence(
+                                   bnb.get_solution()->get_sequence()));
+      reported_ub = solution_pool->get_upper_bound();
+    }
+    std::ostringstream msg;
+    msg.precision(17);
+    msg << "DONE " << id << " " << bnb.get_lower_bound();
+    connection.send(msg.str());
+    ++num_solved;
+    if (timer.timeout()) {
+      break;
+    }
+  }
+  return num_solved;
+}
+} // namespace cetsp
@@ -0,0 +1,143 @@
+//
+// Diving heuristic on a spare thread.
+//
+#include "cetsp/diving_heuristic.h"
+#include <limits>
+
+namespace cetsp {
+
+DivingHeuristicCallback::~DivingHeuristicCallback() { stop_dive(); }
+
+void DivingHeuristicCallback::stop_dive() {
+  abort = true;
+  if (worker.joinable()) {
+    worker.join();
+  }
+  abort = false; // the next `optimize` may dive again
+}
+
+void DivingHeuristicCallback::on_termination(EventContext &context) {
+  stop_dive();
+  add_pending_solution(context);
+}
+
+void DivingHeuristicCallback::on_entering_node(EventContext &context) {
+  const auto ub = context.get_upper_bound();
+  if (ub < last_upper_bound) {
+    last_upper_bound = ub;
+    last_improvement = context.num_iterations;
+  }
+  add_pending_solution(context);
+  if (should_dive(context)) {
+    start_dive(context);
+  }
+}
+
+bool DivingHeuristicCallback::should_dive(const EventContext &context) const {
+  if (running) {
+    return false;
+  }
+  const auto since_dive = context.num_iterations - last_dive;
+  if (since_dive >= interval) {
+    return true;
+  }
+  const auto stagnating =
+      context.num_iterations - last_improvement >= stagnation_interval;
+  return stagnating && since_dive >= stagnation_interval;
+}
+
+void DivingHeuristicCallback::add_pending_solution(EventContext &context) {
+  std::optional<DiveResult> pending;
+  {
+    std::lock_guard<std::mutex> lock(result_mutex);
+    pending.swap(result);
+  }
+  if (!pending || pending->trajectory.length() >= context.get_upper_bound()) {
+    return;
+  }
+  PartialSequenceSolution candidate(
+      context.instance, std::move(pending->sequence),
+      std::move(pending->trajectory), std::move(pending->spanning_information));
+  // Lazy circles may have been added while diving.
+  if (candidate.is_feasible()) {
+    Solution solution(std::move(candidate));
+    context.add_solution(solution);
+  }
+}
+
+void DivingHeuristicCallback::start_dive(const EventContext &context) {
+  if (worker.joinable()) {
+    worker.join(); // the previous dive is done, as we are not running
+  }
+  last_dive = context.num_iterations;
+  ++num_dives;
+  running = true;
+  // The dive works on copies, as the instance may be extended by lazy
+  // constraints in the meantime.
+  worker = std::thread(
+      [this, instance = *context.instance,
+       sequence = context.current_node->get_fixed_sequence()]() {
+        auto solution = dive(instance, sequence, abort);
+        if (solution) {
+          const auto &sequence = solution->get_sequence();
+          std::vector<bool> spanning_information(sequence.size());
+          for (unsigned i = 0; i < sequence.size(); ++i) {
+            spanning_information[i] = solution->is_sequence_index_spanning(i);
+          }
+          std::lock_guard<std::mutex> lock(result_mutex);
+          result = DiveResult{sequence, solution->get_trajectory(),
+                              std::move(spanning_information)};
+        }
+        running = false;
+      });
+}
+
+std::optional<Solution>
+DivingHeuristicCallback::dive(const Instance &instance,
+                              std::vector<int> sequence,
+                              const std::atomic<bool> &abort) {
+  if (sequence.empty() && instance.is_tour()) {
+    if (instance.empty()) {
+      return std::nullopt;
+    }
+    sequence.push_back(0);
+  }
+  while (!abort) {
+    PartialSequenceSolution solution(&instance, sequence);
+    std::optional<int> farthest;
+    double max_dist = 0;
+    for (int i = 0; i < static_cast<int>(instance.size()); ++i) {
+      if (solution.covers(i)) {
+        continue;
+      }
+      const auto dist = solution.distance(i);
+      if (!farthest || dist > max_dist) {
+        farthest = i;
+        max_dist = dist;
+      }
+    }
+    if (!farthest) {
+      return Solution(std::move(solution));
+    }
+    // Insert between the two consecutive trajectory points with the smallest
+    // detour via the circle's center.
+    const auto &points = solution.get_trajectory().points;
+    const auto &center = instance[*farthest].center;
+    size_t best = 0;
+    double best_detour = std::numeric_limits<double>::infinity();
+    for (size_t k = 0; k + 1 < points.size(); ++k) {
+      const auto detour = points[k].dist(center) +
+                          center.dist(points[k + 1]) -
+                          points[k].dist(points[k + 1]);
+      if (detour < best_detour) {
+        best_detour = detour;
+        best = k;
+      }
+    }
+    // For paths, the first point is the fixed start and not in the sequence.
+    const auto position = instance.is_path() ? best : best + 1;
+    sequence.insert(sequence.begin() + static_cast<long>(position), *farthest);
+  }
+  return std::nullopt;
+}
+} // namespace cetsp
@@ -2,10 +2,14 @@
 // Created by Dominik Krupke on 11.12.22.
 //
 
+#include "cetsp/heuristics.h"
+#include "cetsp/bnb.h"
 #include "cetsp/common.h"
 #include "cetsp/relaxed_solution.h"
 #include "cetsp/soc.h"
+#include "cetsp/strategies/rules/global_convex_hull_rule.h"
 #include <algorithm>
+#include <boost/thread/thread.hpp>
 #include <iostream>
 #include <random>
 namespace cetsp {
@@ -26,16 +30,10 @@ bool swap_improves(std::vector<std::pair<Circle, int>> &circles, int i, int j) {
   return new_dist < 0.999 * prev_dist;
 }
 
-Solution compute_tour_by_2opt(Instance &instance) {
-  auto rd = std::random_device{};
-  auto rng = std::default_random_engine{rd()};
-  std::vector<std::pair<Circle, int>> circles;
-  int i = 0;
-  for (const auto &c : instance) {
-    circles.push_back({c, i});
-    i++;
-  }
-  std::shuffle(std::begin(circles), std::end(circles), rng);
+/**
+ * Improves the order of the circles by 2-Opt on their centers.
+ */
+void improve_by_2opt(std::vector<std::pair<Circle, int>> &circles) {
   bool changed = true;
   const auto n = circles.size();
   while (changed) {
@@ -50,6 +48,19 @@ Solution compute_tour_by_2opt(Instance &instance) {
       }
     }
   }
+}
+
+Solution compute_tour_by_2opt(Instance &instance) {
+  auto rd = std::random_device{};
+  auto rng = std::default_random_engine{rd()};
+  std::vector<std::pair<Circle, int>> circles;
+  int i = 0;
+  for (const auto &c : instance) {
+    circles.push_back({c, i});
+    i++;
+  }
+  std::shuffle(std::begin(circles), std::end(circles), rng);
+  improve_by_2opt(circles);
   // TODO: This is ugly as it does not care for begin and end.
   std::vector<int> sequence;
   for (const auto &c : circles) {
@@ -59,4 +70,254 @@ Solution compute_tour_by_2opt(Instance &instance) {
   sol.simplify();
   return sol;
 }
+
+namespace {
+/**
+ * Assigns every circle to one of `k` clusters by k-means on the centers
+ * (k-means++ initialization, deterministic seed).
+ */
+std::vector<size_t> cluster_by_kmeans(const Instance &instance, size_t k) {
+  const auto n = instance.size();
+  std::mt19937 rng{0};
+  std::vector<Point> centroids;
+  std::vector<double> min_dist(n, std::numeric_limits<double>::infinity());
+  centroids.push_back(
+      instance[std::uniform_int_distribution<size_t>(0, n - 1)(rng)].center);
+  while (centroids.size() < k) {
+    for (size_t i = 0; i < n; ++i) {
+      min_dist[i] =
+          std::min(min_dist[i], instance[i].center.squared_dist(centroids.back()));
+    }
+    if (std::all_of(min_dist.begin(), min_dist.end(),
+                    [](double d) { return d <= 0; })) {
+      break; // fewer distinct centers than clusters
+    }
+    std::discrete_distribution<size_t> next(min_dist.begin(), min_dist.end());
+    centroids.push_back(instance[next(rng)].center);
+  }
+  k = centroids.size();
+  std::vector<size_t> assignment(n, k);
+  constexpr int MAX_ITERATIONS = 25;
+  for (int iteration = 0; iteration < MAX_ITERATIONS; ++iteration) {
+    bool changed = false;
+    for (size_t i = 0; i < n; ++i) {
+      size_t best = 0;
+      for (size_t c = 1; c < k; ++c) {
+        if (instance[i].center.squared_dist(centroids[c]) <
+            instance[i].center.squared_dist(centroids[best])) {
+          best = c;
+        }
+      }
+      changed = changed || assignment[i] != best;
+      assignment[i] = best;
+    }
+    if (!changed) {
+      break;
+    }
+    std::vector<double> sum_x(k, 0), sum_y(k, 0);
+    std::vector<size_t> count(k, 0);
+    for (size_t i = 0; i < n; ++i) {
+      sum_x[assignment[i]] += instance[i].center.x;
+      sum_y[assignment[i]] += instance[i].center.y;
+      count[assignment[i]] += 1;
+    }
+    for (size_t c = 0; c < k; ++c) {
+      if (count[c] > 0) { // empty clusters keep their centroid
+        centroids[c] = Point(sum_x[c] / count[c], sum_y[c] / count[c]);
+      }
+    }
+  }
+  return assignment;
+}
+
+/**
+ * Computes a tour through the given circles with a time limited BnB. With
+ * less than a second, only the 2-opt tour is computed, as the BnB can only
+ * be limited to full seconds.
+ * @return The sequence of the tour, as indices of the instance.
+ */
+std::vector<int> solve_cluster(const Instance &instance,
+                               const std::vector<int> &members,
+                               double time_limit_s) {
+  // Circles containing other circles are skipped by `add_circle`.
+  Instance cluster;
+  std::vector<int> to_instance_index;
+  for (const auto i : members) {
+    auto circle = instance[i];
+    const auto size_before = cluster.size();
+    cluster.add_circle(circle);
+    if (cluster.size() > size_before) {
+      to_instance_index.push_back(i);
+    }
+  }
+  if (cluster.size() <= 3) { // every order is optimal
+    return to_instance_index;
+  }
+  auto upper_bound = compute_tour_by_2opt(cluster);
+  std::vector<int> tour;
+  if (time_limit_s < 1) {
+    for (const auto i : upper_bound.get_sequence()) {
+      tour.push_back(to_instance_index[i]);
+    }
+    return tour;
+  }
+  // The clusters are solved on parallel threads, which would mix the log.
+  utils::QuietScope quiet;
+  ConvexHullRoot root_strategy;
+  ChFarthestCircle branching_strategy(false, 1);
+  branching_strategy.enable_objective_cutoff(0.01);
+  branching_strategy.add_rule(std::make_unique<GlobalConvexHullRule>());
+  CheapestChildDepthFirst search_strategy;
+  BranchAndBoundAlgorithm bnb(&cluster, root_strategy.get_root_node(cluster),
+                              branching_strategy, search_strategy);
+  bnb.add_upper_bound(upper_bound);
+  bnb.optimize(static_cast<int>(time_limit_s), 0.01, false);
+  for (const auto i : bnb.get_solution()->get_sequence()) {
+    tour.push_back(to_instance_index[i]);
+  }
+  return tour;
+}
+
+/**
+ * Opens the cluster tour at the edge that is cheapest to replace by the
+ * connections from `entry` and to `exit`, and appends it to `sequence`.
+ */
+void append_opened_tour(const Instance &instance, const std::vector<int> &tour,
+                        const Point &entry, const Point &exit,
+                        std::vector<int> &sequence) {
+  const auto m = static_cast<int>(tour.size());
+  auto center = [&](int j) -> const Point & {
+    return instance[tour[(j + m) % m]].center;
+  };
+  double best_cost = std::numeric_limits<double>::infinity();
+  int best_edge = 0;
+  bool best_forward = true;
+  for (int j = 0; j < m; ++j) { // remove the edge from j to j+1
+    const auto removed = center(j).dist(center(j + 1));
+    const auto forward =
+        entry.dist(center(j + 1)) + center(j).dist(exit) - removed;
+    const auto backward =
+        entry.dist(center(j)) + center(j + 1).dist(exit) - removed;
+    if (forward < best_cost) {
+      best_cost = forward;
+      best_edge = j;
+      best_forward = true;
+    }
+    if (backward < best_cost) {
+      best_cost = backward;
+      best_edge = j;
+      best_forward = false;
+    }
+  }
+  for (int k = 1; k <= m; ++k) {
+    const auto j = best_forward ? best_edge + k : best_edge + 1 - k;
+    sequence.push_back(tour[((j % m) + m) % m]);
+  }
+}
+
+/**
+ * Recomputes the trajectory for the sequence and inserts the circles that
+ * are not covered at the position with the smallest detour, until the
+ * solution is feasible.
+ */
+Solution insert_uncovered_circles(const Instance &instance,
+                                  std::vector<int> sequence) {
+  while (true) {
+    PartialSequenceSolution solution(&instance, sequence);
+    std::vector<int> uncovered;
+    for (int i = 0; i < static_cast<int>(instance.size()); ++i) {
+      if (!solution.covers(i)) {
+        uncovered.push_back(i);
+      }
+    }
+    if (uncovered.empty()) {
+      Solution result(std::move(solution));
+      result.simplify();
+      return result;
+    }
+    for (const auto c : uncovered) {
+      const auto &p = instance[c].center;
+      size_t best_pos = 0;
+      double best_detour = std::numeric_limits<double>::infinity();
+      for (size_t j = 0; j < sequence.size(); ++j) {
+        const auto &a = instance[sequence[j]].center;
+        const auto &b = instance[sequence[(j + 1) % sequence.size()]].center;
+        const auto detour = a.dist(p) + p.dist(b) - a.dist(b);
+        if (detour < best_detour) {
+          best_detour = detour;
+          best_pos = j + 1;
+        }
+      }
+      sequence.insert(sequence.begin() + static_cast<long>(best_pos), c);
+    }
+  }
+}
+} // namespace
+
+Solution compute_tour_by_clustering(Instance &instance, size_t cluster_size,
+                                    double time_limit_s, unsigned num_threads) {
+  if (instance.is_path()) {
+    throw std::invalid_argument("Clustering heuristic only supports tours.");
+  }
+  const auto k =
+      std::max<size_t>(1, (instance.size() + cluster_size - 1) / cluster_size);
+  const auto assignment = cluster_by_kmeans(instance, k);
+  std::vector<std::vector<int>> members(k);
+  for (int i = 0; i < static_cast<int>(instance.size()); ++i) {
+    members[assignment[i]].push_back(i);
+  }
+  members.erase(std::remove_if(members.begin(), members.end(),
+                               [](const auto &m) { return m.empty(); }),
+                members.end());
+
+  // Solve the clusters in parallel. The time limit is shared evenly, but a
+  // cluster never gets more than what is left.
+  utils::Timer timer(time_limit_s);
+  const auto num_clusters = members.size();
+  num_threads = std::max(1u, num_threads);
+  const auto time_per_cluster =
+      time_limit_s * std::min<size_t>(num_threads, num_clusters) /
+      static_cast<double>(num_clusters);
+  std::vector<std::vector<int>> tours(num_clusters);
+  auto solve = [&](size_t offset) {
+    for (auto c = offset; c < num_clusters; c += num_threads) {
+      const auto remaining = time_limit_s - timer.seconds();
+      tours[c] = solve_cluster(instance, members[c],
+                               std::min(time_per_cluster, remaining));
+    }
+  };
+  boost::thread_group tg;
+  if (num_threads <= 1) {
+    solve(0);
+  } else {
+    for (size_t offset = 0; offset < std::min<size_t>(num_threads, num_clusters);
+         ++offset) {
+      tg.create_thread([&solve, offset]() { solve(offset); });
+    }
+  }
+  tg.join_all();
+
+  // Visit the clusters in the order of a tour through their centroids.
+  std::vector<std::pair<Circle, int>> centroids;
+  for (int c = 0; c < static_cast<int>(num_clusters); ++c) {
+    double x = 0, y = 0;
+    for (const auto i : members[c]) {
+      x += instance[i].center.x;
+      y += instance[i].center.y;
+    }
+    const auto size = static_cast<double>(members[c].size());
+    centroids.push_back({Circle(Point(x / size, y / size), 0), c});
+  }
+  improve_by_2opt(centroids);
+
+  std::vector<int> sequence;
+  auto entry = centroids.back().first.center;
+  for (size_t c = 0; c < num_clusters; ++c) {
+    const auto &exit = centroids[(c + 1) % num_clusters].first.center;
+    append_opened_tour(instance, tours[centroids[c].second], entry, exit,
+                       sequence);
+    entry = instance[sequence.back()].center;
+  }
+  return insert_uncovered_circles(instance, std::move(sequence));
+}
 } // namespace cetsp
@@ -10,30 +10,62 @@ static bool is_segments_intersect(const Point &p11, const Point &p12,
 
 void Node::add_lower_bound(const double lb) {
   if (get_lower_bound() < lb) {
+    // The children will see the new bound lazily via the epoch.
     lazy_lower_bound_value = lb;
+    invalidate_bounds();
     // propagate to parent
     if (parent != nullptr && parent->get_lower_bound() < lb) {
       parent->reevaluate_children();
     }
-    // Potentially also propagate to children.
-    if (!children.empty()) {
-      for (auto &child : children) {
-        child->add_lower_bound(lb);
-      }
-    }
   }
 }
 
-auto Node::get_lower_bound() -> double {
+double Node::get_own_lower_bound() {
   if (!lazy_lower_bound_value) {
     lazy_lower_bound_value = get_relaxed_solution().obj();
+  }
+  return *lazy_lower_bound_value;
+}
+
+auto Node::get_lower_bound() -> double {
+  const auto epoch = bound_epoch->load();
+  if (cached_lower_bound_epoch != epoch) {
+    cached_lower_bound = get_own_lower_bound();
     if (parent != nullptr) {
-      if (lazy_lower_bound_value < parent->get_lower_bound()) {
-        lazy_lower_bound_value = parent->get_lower_bound();
-      }
+      cached_lower_bound =
+          std::max(cached_lower_bound, parent->get_lower_bound());
     }
+    cached_lower_bound_epoch = epoch;
   }
-  return *lazy_lower_bound_value;
+  return cached_lower_bound;
+}
+
+auto Node::is_pruned() const -> bool {
+  const auto epoch = bound_epoch->load();
+  if (cached_pruned_epoch != epoch) {
+    cached_pruned = pruned || (parent != nullptr && parent->is_pruned());
+    cached_pruned_epoch = epoch;
+  }
+  return cached_pruned;
+}
+
+bool Node::trigger_lazy_evaluation(const double cutoff) {
+  auto lb = _relaxed_solution.trigger_lazy_computation_with_cutoff(cutoff);
+  // Only the own bound is set, the parent is considered lazily. Thus, the
+  // parent is not touched.
+  if (lazy_lower_bound_value) {
+    lb = std::max(lb, *lazy_lower_bound_value);
+  }
+  lazy_lower_bound_value = lb;
+  if (!_relaxed_solution.is_computed()) {
+    // Do not use `prune` as it may propagate the bound to the parent.
+    pruned = true;
+    invalidate_bounds();
+    return true;
+  }
+  invalidate_bounds();
+  _relaxed_solution.is_feasible();
+  return false;
 }
 
 bool Node::is_feasible() { return _relaxed_solution.is_feasible(); }
@@ -43,11 +75,23 @@ void Node::branch(std::vector<std::shared_ptr<Node>> &children_) {
     throw std::invalid_argument("Cannot branch on pruned node.");
   }
   assert(!is_feasible());
+  children.clear();
+  for (auto &child : children_) {
+    if (child->is_pruned()) {
+      // Cut off during the evaluation. Only its bound is kept.
+      cut_off_lower_bound =
+          std::min(cut_off_lower_bound, child->get_lower_bound());
+    } else {
+      children.push_back(child);
+    }
+  }
   if (children_.empty()) {
     prune();
-    children = std::vector<std::shared_ptr<Node>>{};
+  } else if (children.empty()) {
+    // All children have been cut off, which is a bound, not infeasibility.
+    add_lower_bound(cut_off_lower_bound);
+    prune(false);
   } else {
-    children = children_;
     reevaluate_children();
   }
 }
@@ -61,22 +105,56 @@ void Node::prune(bool infeasible) {
     return;
   }
   pruned = true;
+  invalidate_bounds(); // the subtree will see the pruning lazily
   if (infeasible) {
     add_lower_bound(std::numeric_limits<double>::infinity());
   }
-  for (auto &child : children) {
-    child->prune(infeasible);
-  }
 }
 
 void Node::reevaluate_children() {
-  if (!children.empty()) {
+  if (!children.empty() || !detached_lower_bounds.empty()) {
+    // The effective bound of a child is the maximum of its own bound and the
+    // bound of this node. Resolving this directly instead of via the cache of
+    // every child keeps the update in O(children) after resolving this node.
     auto lb = std::transform_reduce(
         children.begin(), children.end(),
         std::numeric_limits<double>::infinity(),
         [](double a, double b) { return std::min(a, b); },
-        [](std::shared_ptr<Node> &node) { return node->get_lower_bound(); });
-    add_lower_bound(lb);
+        [](std::shared_ptr<Node> &node) {
+          return node->get_own_lower_bound();
+        });
+    lb = std::min(lb, cut_off_lower_bound);
+    for (const auto detached_lb : detached_lower_bounds) {
+      lb = std::min(lb, detached_lb);
+    }
+    add_lower_bound(std::max(lb, get_lower_bound()));
+  }
+}
+
+size_t Node::detach_child(const Node *child) {
+  auto it = std::find_if(children.begin(), children.end(),
+                         [child](const auto &c) { return c.get() == child; });
+  if (it == children.end()) {
+    throw std::invalid_argument("Can only detach children of this node.");
+  }
+  const auto lb = (*it)->get_lower_bound();
+  children.erase(it);
+  detached_lower_bounds.push_back(lb);
+  ++num_detached_children;
+  return detached_lower_bounds.size() - 1;
+}
+
+void Node::attach_child(std::shared_ptr<Node> child, const size_t slot) {
+  assert(child->get_parent() == this);
+  release_detached_child(slot);
+  children.push_back(std::move(child));
+}
+
+void Node::release_detached_child(const size_t slot) {
+  assert(slot < detached_lower_bounds.size());
+  detached_lower_bounds[slot] = std::numeric_limits<double>::infinity();
+  if (--num_detached_children == 0) {
+    detached_lower_bounds.clear(); // all slots are free again
   }
 }
 
@@ -103,7 +181,7 @@ std::vector<TrajectoryIntersection> Node::get_intersections() {
   std::vector<TrajectoryIntersection> intersections;
   for (unsigned int i = 0; i < edges.size(); i++) {
     for (unsigned int j = 0; j < edges.size(); j++) {
-      unsigned int i_prev = ((int)i - 1) % edges.size();
+      unsigned int i_prev = (i + edges.size() - 1) % edges.size();
       unsigned int i_next = (i + 1) % edges.size();
       if (j == i_prev || j == i || j == i_next)
         continue;
@@ -113,7 +191,8 @@ std::vector<TrajectoryIntersection> Node::get_intersections() {
                                 std::get<1>(b))) {
         intersections.push_back(TrajectoryIntersection(
             std::get<0>(a), std::get<1>(a), std::get<2>(a), std::get<3>(a),
-            std::get<0>(b), std::get<1>(b), std::get<2>(b), std::get<3>(b)));
+            std::get<0>(b), std::get<1>(b), std::get<2>(b), std::get<3>(b), i,
+            j));
       }
     }
   }
@@ -0,0 +1,162 @@
+//
+// Memory-mapped spill file for open BnB nodes.
+//
+#include "cetsp/details/node_spill.h"
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace cetsp::details {
+
+size_t estimate_memory_usage(Node &node) {
+  const auto sequence_length = node.get_fixed_sequence().size();
+  return sizeof(Node) + sequence_length * sizeof(int) +
+         (sequence_length + 2) * sizeof(Point) + sequence_length / 8 +
+         node.get_instance()->size() * sizeof(double);
+}
+
+static std::runtime_error spill_error(const std::string &what,
+                                      const std::string &path) {
+  return std::runtime_error("Node spill: " + what + " '" + path +
+                            "': " + std::strerror(errno));
+}
+
+NodeSpill::NodeSpill(std::string path_) : path{std::move(path_)} {
+  fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+  if (fd < 0) {
+    throw spill_error("Could not open", path);
+  }
+  reserve(1 << 20);
+}
+
+std::string NodeSpill::temporary_path() {
+  static std::atomic<uint64_t> counter{0};
+  const auto name = "cetsp_spill_" + std::to_string(::getpid()) + "_" +
+                    std::to_string(counter.fetch_add(1));
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+NodeSpill::~NodeSpill() {
+  if (mapping != nullptr) {
+    ::munmap(mapping, capacity);
+  }
+  if (fd >= 0) {
+    ::close(fd);
+    ::unlink(path.c_str());
+  }
+}
+
+void NodeSpill::reserve(size_t bytes) {
+  if (bytes <= capacity) {
+    return;
+  }
+  auto new_capacity = std::max<size_t>(capacity, 1 << 20);
+  while (new_capacity < bytes) {
+    new_capacity *= 2;
+  }
+  if (mapping != nullptr) {
+    ::munmap(mapping, capacity);
+    mapping = nullptr;
+  }
+  if (::ftruncate(fd, static_cast<off_t>(new_capacity)) != 0) {
+    throw spill_error("Could not grow", path);
+  }
+  void *m = ::mmap(nullptr, new_capacity, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   fd, 0);
+  if (m == MAP_FAILED) {
+    throw spill_error("Could not map", path);
+  }
+  mapping = static_cast<char *>(m);
+  capacity = new_capacity;
+}
+
+uint64_t NodeSpill::get_parent_id(Node *parent) {
+  auto it = parent_ids.find(parent);
+  if (it == parent_ids.end()) {
+    it = parent_ids.emplace(parent, next_parent_id++).first;
+    parents[it->second] = {parent, 0};
+  }
+  ++parents[it->second].num_spilled_children;
+  return it->second;
+}
+
+Node *NodeSpill::release_parent_id(const uint64_t id) {
+  auto it = parents.find(id);
+  assert(it != parents.end());
+  Node *parent = it->second.node;
+  if (--it->second.num_spilled_children == 0) {
+    parent_ids.erase(parent);
+    parents.erase(it);
+  }
+  return parent;
+}
+
+bool NodeSpill::spill(Node &node) {
+  Node *parent = node.get_parent();
+  if (parent == nullptr || node.is_pruned()) {
+    return false;
+  }
+  const auto &sequence = node.get_fixed_sequence();
+  RecordHeader header{};
+  header.lower_bound = node.get_lower_bound();
+  header.parent_id = get_parent_id(parent);
+  header.sequence_length = static_cast<uint32_t>(sequence.size());
+  const auto obj = node.get_relaxed_solution().obj();
+  // keep the records aligned
+  auto record_size = sizeof(RecordHeader) + sequence.size() * sizeof(int32_t);
+  record_size = (record_size + 7) & ~static_cast<size_t>(7);
+  header.parent_slot = parent->detach_child(&node);
+  reserve(end + record_size);
+  std::memcpy(mapping + end, &header, sizeof(RecordHeader));
+  auto *seq_out = mapping + end + sizeof(RecordHeader);
+  for (const auto i : sequence) {
+    const auto i32 = static_cast<int32_t>(i);
+    std::memcpy(seq_out, &i32, sizeof(int32_t));
+    seq_out += sizeof(int32_t);
+  }
+  index.push({header.lower_bound, obj, end});
+  end += record_size;
+  return true;
+}
+
+std::shared_ptr<Node> NodeSpill::reload() {
+  while (!index.empty()) {
+    const auto entry = index.top();
+    index.pop();
+    RecordHeader header{};
+    std::memcpy(&header, mapping + entry.offset, sizeof(RecordHeader));
+    std::vector<int> sequence(header.sequence_length);
+    const auto *seq_in = mapping + entry.offset + sizeof(RecordHeader);
+    for (auto &i : sequence) {
+      int32_t i32;
+      std::memcpy(&i32, seq_in, sizeof(int32_t));
+      i = i32;
+      seq_in += sizeof(int32_t);
+    }
+    if (index.empty()) {
+      end = 0; // the whole file can be reused
+    }
+    Node *parent = release_parent_id(header.parent_id);
+    if (parent->is_pruned()) {
+      // the subtree is no longer of interest
+      parent->release_detached_child(header.parent_slot);
+      continue;
+    }
+    auto node =
+        std::make_shared<Node>(sequence, parent->get_instance(), parent);
+    parent->attach_child(node, header.parent_slot);
+    // The bound is reused. The trajectory is recomputed right away, as the
+    // bound is only raised above the length of the trajectory and the search
+    // strategies need the length to order the node.
+    node->add_lower_bound(header.lower_bound);
+    return node;
+  }
+  return nullptr;
+}
+} // namespace cetsp::details
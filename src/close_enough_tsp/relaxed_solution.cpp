@@ -1,4 +1,5 @@
 #include "cetsp/relaxed_solution.h"
+#include "cetsp/details/profiling.h"
 #include "cetsp/soc.h"
 //
 // Created by Dominik Krupke on 15.01.23.
@@ -6,41 +7,18 @@
 
 namespace cetsp::details {
 void LazyTrajectoryComputation::compute_trajectory() const {
-  if (instance->is_path()) {
-    compute_path_trajectory();
-  } else {
-    compute_tour_trajectory();
-  };
+  data = compute_trajectory_with_information(*instance, sequence);
 }
-void LazyTrajectoryComputation::compute_tour_trajectory() const {
-  // compute the optimal tour trajectory through the sequence
-  std::vector<Circle> circles;
-  circles.reserve(sequence.size());
-  for (auto i : sequence) {
-    assert(i < static_cast<int>(instance->size()));
-    circles.push_back((*instance).at(i));
-  }
-  assert(circles.size() == sequence.size());
-  auto soc = compute_trajectory_with_information(circles, false);
-  data = std::move(soc);
-}
-void LazyTrajectoryComputation::compute_path_trajectory() const {
-  // compute the optimal path trajectory through the sequence
-  std::vector<Circle> circles;
-  circles.reserve(sequence.size() + 2);
-  circles.emplace_back(instance->path->first, 0);
-  for (auto i : sequence) {
-    circles.push_back((*instance).at(i));
+
+double LazyTrajectoryComputation::trigger_computation(double cutoff) const {
+  if (data) {
+    return data->first.length();
   }
-  circles.emplace_back(instance->path->second, 0);
-  assert(circles.size() == sequence.size() + 2);
-  auto soc = compute_trajectory_with_information(circles, true);
-  const int n = static_cast<int>(soc.second.size());
-  for (int i = 1; i < n - 1; ++i) {
-    soc.second[i - 1] = soc.second[i];
+  auto soc = compute_trajectory_with_cutoff(*instance, sequence, cutoff);
+  if (!soc.is_cut_off()) {
+    data = std::move(*soc.trajectory);
   }
-  soc.second.pop_back(); // remove last element
-  data = std::move(soc);
+  return soc.lower_bound;
 }
 
 } // namespace cetsp::details
@@ -56,11 +34,15 @@ void cetsp::PartialSequenceSolution::simplify() {
     // sequence
     points.push_back(trajectory_begin());
   }
-  // add all spanning circles and their hitting points
+  // add all spanning circles and their hitting points. The mode is checked
+  // once instead of for every hitting point.
   const auto &sequence = spanning_trajectory.sequence;
+  const auto &spanning = spanning_trajectory.get_spanning_information();
+  const auto &hitting_points = get_trajectory().points;
+  const int offset = instance->is_path() ? 1 : 0;
   for (int i = 0; i < sequence.size(); ++i) {
-    if (is_sequence_index_spanning(i)) {
-      points.push_back(get_sequence_hitting_point(i));
+    if (spanning[i]) {
+      points.push_back(hitting_points[i + offset]);
       simplified_sequence.push_back(sequence[i]);
       is_spanning.push_back(true);
     }
@@ -84,6 +66,7 @@ bool cetsp::PartialSequenceSolution::is_feasible() const {
     return false;
   }
   if (!_feasible || *_feasible) {
+    CETSP_PROFILE_SCOPE(FEASIBILITY);
     _feasible = true;
     // will be cached if the instance hasn't changed. Otherwise, only the
     // unchecked instances will be checked.
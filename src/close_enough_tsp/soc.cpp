@@ -1,33 +1,115 @@
 #include "cetsp/soc.h"
 #include "cetsp/common.h"
+#include "cetsp/details/profiling.h"
+#include "cetsp/details/trajectory_mode.h"
 #include <gurobi_c++.h>
 #include <vector>
 namespace cetsp {
 
-std::pair<Trajectory, std::vector<bool>>
-compute_trajectory_with_information(const std::vector<Circle> &circle_sequence,
-                                    bool path) {
-  constexpr auto SPANNING_TOLERANCE = 0.01;
+namespace {
+using details::PathMode;
+using details::TourMode;
+
+/**
+ * The variables of a single circle sequence within a model. Only the
+ * variables that are needed to extract the solution are kept.
+ */
+struct SequenceVariables {
+  std::vector<GRBVar> x;
+  std::vector<GRBVar> y;
+  std::vector<GRBVar> s;
+  std::vector<GRBVar> t;
+};
+
+/**
+ * A plain sequence of circles. For paths, the first and last circle are
+ * the ends of the trajectory and part of the spanning information.
+ */
+class CircleSequence {
+public:
+  explicit CircleSequence(const std::vector<Circle> &circles)
+      : circles{circles} {}
+
+  [[nodiscard]] size_t size() const { return circles.size(); }
+  [[nodiscard]] const Circle &operator[](size_t i) const { return circles[i]; }
+  // The circles for which spanning information is returned.
+  [[nodiscard]] size_t spanning_begin() const { return 0; }
+  [[nodiscard]] size_t spanning_end() const { return circles.size(); }
+
+private:
+  const std::vector<Circle> &circles;
+};
+
+/**
+ * A sequence of circle indices of an instance, read directly from the
+ * instance. For paths, the fixed endpoints of the instance are added as
+ * circles with radius zero without copying the sequence. The spanning
+ * information only covers the sequence.
+ */
+template <typename Mode> class InstanceSequence {
+public:
+  InstanceSequence(const Instance &instance, const std::vector<int> &sequence)
+      : instance{instance}, sequence{sequence} {}
+
+  [[nodiscard]] size_t size() const {
+    return Mode::is_path ? sequence.size() + 2 : sequence.size();
+  }
+
+  [[nodiscard]] Circle operator[](size_t i) const {
+    if constexpr (Mode::is_path) {
+      if (i == 0) {
+        return {instance.path->first, 0};
+      }
+      if (i == sequence.size() + 1) {
+        return {instance.path->second, 0};
+      }
+      return instance[sequence[i - 1]];
+    } else {
+      return instance[sequence[i]];
+    }
+  }
 
+  [[nodiscard]] size_t spanning_begin() const { return Mode::is_path ? 1 : 0; }
+  [[nodiscard]] size_t spanning_end() const {
+    return spanning_begin() + sequence.size();
+  }
+
+private:
+  const Instance &instance;
+  const std::vector<int> &sequence;
+};
+
+GRBEnv &get_env() {
   static GRBEnv env;
-  GRBModel model(&env);
+  return env;
+}
 
+/**
+ * Adds the variables and constraints for the shortest trajectory through
+ * the circle sequence to the model. The length of the trajectory is added
+ * to `obj`. The constraints of different sequences do not interact, so
+ * multiple sequences can be added to the same model.
+ */
+template <typename Mode, typename Circles>
+SequenceVariables add_sequence_to_model(GRBModel &model,
+                                        const Circles &circle_sequence,
+                                        GRBLinExpr &obj) {
   const auto n = circle_sequence.size();
-  std::vector<GRBVar> x;
-  x.resize(n);
-  std::vector<GRBVar> y;
-  y.resize(n);
+  SequenceVariables vars;
+  vars.x.resize(n);
+  vars.y.resize(n);
+  vars.s.resize(n);
+  vars.t.resize(n);
   std::vector<GRBVar> f;
   f.resize(n);
   std::vector<GRBVar> w;
   w.resize(n);
   std::vector<GRBVar> u;
   u.resize(n);
-  std::vector<GRBVar> s;
-  s.resize(n);
-  std::vector<GRBVar> t;
-  t.resize(n);
-  GRBLinExpr obj = 0;
+  auto &x = vars.x;
+  auto &y = vars.y;
+  auto &s = vars.s;
+  auto &t = vars.t;
 
   for (unsigned i = 0; i < n; ++i) {
     x[i] = model.addVar(/*lb=*/-GRB_INFINITY, /*ub=*/GRB_INFINITY,
@@ -53,54 +135,221 @@ compute_trajectory_with_information(const std::vector<Circle> &circle_sequence,
     obj += f[i];
   }
 
-  model.setObjective(obj, GRB_MINIMIZE);
-
   for (unsigned i = 0; i < n; ++i) {
     model.addQConstr(f[i] * f[i] >= w[i] * w[i] + u[i] * u[i]);
-    const auto r = circle_sequence[i].radius;
+    const Circle &circle = circle_sequence[i];
+    const auto r = circle.radius;
     model.addQConstr(s[i] * s[i] + t[i] * t[i] <= r * r);
 
-    const auto cx = circle_sequence[i].center.x;
-    const auto cy = circle_sequence[i].center.y;
+    const auto cx = circle.center.x;
+    const auto cy = circle.center.y;
     model.addConstr(s[i] == cx - x[i]);
     model.addConstr(t[i] == cy - y[i]);
   }
 
-  for (unsigned i = 0; i < n; ++i) {
-    if (path && i == 0) {
-      model.addConstr(w[i] == 0);
-      model.addConstr(u[i] == 0);
-    } else {
-      const auto prev_c = (i == 0 ? n - 1 : i - 1);
-      assert(prev_c >= 0);
-      model.addConstr(w[i] == x[prev_c] - x[i]);
-      model.addConstr(u[i] == y[prev_c] - y[i]);
+  // A path has no segment into its first point.
+  unsigned first_segment = 0;
+  if constexpr (Mode::is_path) {
+    if (n > 0) {
+      model.addConstr(w[0] == 0);
+      model.addConstr(u[0] == 0);
     }
+    first_segment = 1;
+  }
+  for (unsigned i = first_segment; i < n; ++i) {
+    const auto prev_c = (i == 0 ? n - 1 : i - 1);
+    model.addConstr(w[i] == x[prev_c] - x[i]);
+    model.addConstr(u[i] == y[prev_c] - y[i]);
   }
+  return vars;
+}
+
+void set_parameters(GRBModel &model) {
   model.set(GRB_IntParam_OutputFlag, 0);
   // tuned via the built-in tune() function of Gurobi.
   model.set(GRB_IntParam_Presolve, 0);
   model.set(GRB_IntParam_SimplexPricing, 3);
   // model.set(GRB_IntParam_PrePasses, 8);
-  model.optimize();
+}
+
+/**
+ * Reads the trajectory and the spanning information of a sequence from an
+ * optimized model.
+ */
+template <typename Mode, typename Circles>
+std::pair<Trajectory, std::vector<bool>>
+extract_solution(const SequenceVariables &vars,
+                 const Circles &circle_sequence) {
+  constexpr auto SPANNING_TOLERANCE = 0.01;
+  const auto n = circle_sequence.size();
+  const auto spanning_begin = circle_sequence.spanning_begin();
   std::vector<Point> points;
   points.reserve(n + 1);
-  std::vector<bool> spanning_circles(n);
+  std::vector<bool> spanning_circles(circle_sequence.spanning_end() -
+                                     spanning_begin);
   for (unsigned i = 0; i < n; i++) {
-    points.emplace_back(x[i].get(GRB_DoubleAttr_X), y[i].get(GRB_DoubleAttr_X));
-    const auto si = s[i].get(GRB_DoubleAttr_X);
-    const auto ti = t[i].get(GRB_DoubleAttr_X);
+    points.emplace_back(vars.x[i].get(GRB_DoubleAttr_X),
+                        vars.y[i].get(GRB_DoubleAttr_X));
+    if (i < spanning_begin || i >= circle_sequence.spanning_end()) {
+      continue;
+    }
+    const auto si = vars.s[i].get(GRB_DoubleAttr_X);
+    const auto ti = vars.t[i].get(GRB_DoubleAttr_X);
     const auto r = circle_sequence[i].radius;
     bool is_spanning =
         std::sqrt(si * si + ti * ti) >= (1 - SPANNING_TOLERANCE) * r;
-    spanning_circles[i] = is_spanning;
+    spanning_circles[i - spanning_begin] = is_spanning;
   }
-  if (!path) {
+  if constexpr (!Mode::is_path) {
     points.push_back(points[0]);
   }
   return {Trajectory(points), spanning_circles};
 }
 
+template <typename Mode, typename Circles>
+std::pair<Trajectory, std::vector<bool>>
+solve_sequence(const Circles &circle_sequence) {
+  GRBModel model(&get_env());
+  GRBLinExpr obj = 0;
+  const auto vars = add_sequence_to_model<Mode>(model, circle_sequence, obj);
+  model.setObjective(obj, GRB_MINIMIZE);
+  set_parameters(model);
+  {
+    CETSP_PROFILE_SCOPE(SOC);
+    model.optimize();
+  }
+  return extract_solution<Mode>(vars, circle_sequence);
+}
+
+/**
+ * Computes a lower bound on the length of the shortest trajectory through
+ * the circles from the dual of the SOC. For every segment, let u_i be a
+ * vector of length at most one (zero if there is no segment into circle i).
+ * Then |p_i - p_{i-1}| >= u_i * (p_i - p_{i-1}) and thus the length is at
+ * least sum_i p_i * v_i with v_i = u_i - u_{i+1}, which is minimized over the
+ * circles by p_i = c_i - r_i * v_i/|v_i|. This is the dual objective for the
+ * dual solution u. Choosing u_i as the directions of the (approximate)
+ * trajectory gives the optimum for an optimal trajectory. The bound does not
+ * require the trajectory to be feasible or optimal, so it is certified for
+ * any tolerance of the solver.
+ */
+template <typename Mode, typename Circles>
+double compute_dual_bound(const Trajectory &trajectory,
+                          const Circles &circle_sequence) {
+  // Relative error of the floating point arithmetic, subtracted such that the
+  // bound stays valid despite rounding.
+  constexpr auto ROUNDING_TOLERANCE = 1e-9;
+  const auto n = circle_sequence.size();
+  const auto &points = trajectory.points;
+  // The direction of the segment into the i-th point.
+  auto direction = [&](size_t i) -> Point {
+    if (i == n) {
+      if constexpr (Mode::is_path) {
+        return {0, 0};
+      }
+      i = 0;
+    }
+    if (Mode::is_path && i == 0) {
+      return {0, 0};
+    }
+    const auto &p = points[i];
+    const auto &prev = points[i == 0 ? n - 1 : i - 1];
+    const auto length = p.dist(prev);
+    if (length <= 0) {
+      return {0, 0};
+    }
+    return {(p.x - prev.x) / length, (p.y - prev.y) / length};
+  };
+  double bound = 0;
+  double magnitude = 0;
+  auto u = direction(0);
+  for (size_t i = 0; i < n; ++i) {
+    const auto u_next = direction(i + 1);
+    const Point v{u.x - u_next.x, u.y - u_next.y};
+    const Circle &circle = circle_sequence[i];
+    const auto center_term = circle.center.x * v.x + circle.center.y * v.y;
+    const auto radius_term = circle.radius * std::sqrt(v.x * v.x + v.y * v.y);
+    bound += center_term - radius_term;
+    magnitude += std::abs(center_term) + radius_term;
+    u = u_next;
+  }
+  return bound - ROUNDING_TOLERANCE * magnitude;
+}
+
+template <typename Mode, typename Circles>
+CutoffSocResult solve_sequence_with_cutoff(const Circles &circle_sequence,
+                                           const double cutoff) {
+  // Relative primal-dual gap to which the SOC is solved. Gurobi's default is
+  // 1e-6, which is more precise than needed for the BnB. The lower bound does
+  // not depend on it, as it is computed from the dual (see
+  // `compute_dual_bound`), but it is at most this much weaker than the optimum.
+  constexpr auto INEXACT_TOLERANCE = 1e-4;
+  GRBModel model(&get_env());
+  GRBLinExpr obj = 0;
+  const auto vars = add_sequence_to_model<Mode>(model, circle_sequence, obj);
+  model.setObjective(obj, GRB_MINIMIZE);
+  set_parameters(model);
+  model.set(GRB_DoubleParam_BarQCPConvTol, INEXACT_TOLERANCE);
+  {
+    CETSP_PROFILE_SCOPE(SOC);
+    model.optimize();
+  }
+  const auto status = model.get(GRB_IntAttr_Status);
+  auto soc = status == GRB_OPTIMAL
+                 ? extract_solution<Mode>(vars, circle_sequence)
+                 // Something went wrong with the inexact solve, e.g.,
+                 // numerical problems. Fall back to the default tolerances.
+                 : solve_sequence<Mode>(circle_sequence);
+  // A valid bound cannot exceed the length of the (feasible) trajectory.
+  // Enforce this to be robust against numerical noise.
+  const auto lb = std::min(compute_dual_bound<Mode>(soc.first, circle_sequence),
+                           soc.first.length());
+  if (lb >= cutoff) {
+    return {{}, lb};
+  }
+  return {std::move(soc), lb};
+}
+} // namespace
+
+std::pair<Trajectory, std::vector<bool>>
+compute_trajectory_with_information(const std::vector<Circle> &circle_sequence,
+                                    bool path) {
+  if (path) {
+    return solve_sequence<PathMode>(CircleSequence(circle_sequence));
+  }
+  return solve_sequence<TourMode>(CircleSequence(circle_sequence));
+}
+
+CutoffSocResult
+compute_trajectory_with_cutoff(const std::vector<Circle> &circle_sequence,
+                               const bool path, const double cutoff) {
+  if (path) {
+    return solve_sequence_with_cutoff<PathMode>(CircleSequence(circle_sequence),
+                                                cutoff);
+  }
+  return solve_sequence_with_cutoff<TourMode>(CircleSequence(circle_sequence),
+                                              cutoff);
+}
+
+std::pair<Trajectory, std::vector<bool>>
+compute_trajectory_with_information(const Instance &instance,
+                                    const std::vector<int> &sequence) {
+  return details::with_trajectory_mode(instance, [&](auto mode) {
+    using Mode = decltype(mode);
+    return solve_sequence<Mode>(InstanceSequence<Mode>(instance, sequence));
+  });
+}
+
+CutoffSocResult compute_trajectory_with_cutoff(const Instance &instance,
+                                               const std::vector<int> &sequence,
+                                               const double cutoff) {
+  return details::with_trajectory_mode(instance, [&](auto mode) {
+    using Mode = decltype(mode);
+    return solve_sequence_with_cutoff<Mode>(
+        InstanceSequence<Mode>(instance, sequence), cutoff);
+  });
+}
+
 Trajectory compute_tour(const std::vector<Circle> &circle_sequence,
                         const bool path) {
   return compute_trajectory_with_information(circle_sequence, path).first;
@@ -1,16 +1,35 @@
 #include "mowing/ExactOffsetCalculator.h"
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <unordered_map>
+#include <boost/thread/thread.hpp>
 
 namespace mowing {
 
-    ExactOffsetCalculator::ExactOffsetCalculator(Input_Linear_polygon &polygon, double radius, bool verbose) {
+    ExactOffsetCalculator::ExactOffsetCalculator(Input_Linear_polygon &polygon, double radius, bool verbose,
+                                                 bool circle_segment_fast_path) {
 
         this->radius = radius;
+        this->circle_segment_fast_path = circle_segment_fast_path;
         this->base_polygon = this->convert_input_polygon(polygon);
 
         if (this->base_polygon.orientation() == CGAL::CLOCKWISE) {
             this->base_polygon.reverse_orientation();
         }
 
+        for (auto it = polygon.vertices_begin(); it != polygon.vertices_end(); it++) {
+            this->input_vertices.emplace_back(CGAL::to_double(it->x()), CGAL::to_double(it->y()));
+        }
+
+        if (circle_segment_fast_path) {
+            // convert_input_polygon already made the input counter-clockwise
+            for (auto it = polygon.edges_begin(); it != polygon.edges_end(); it++) {
+                this->circle_segment_base_polygon.push_back(
+                        Circle_segment_traits::X_monotone_curve_2(it->source(), it->target()));
+            }
+        }
+
         this->initializeUncoveredRegions();
 
         this->verbose = verbose;
@@ -53,7 +72,26 @@ namespace mowing {
 
     void ExactOffsetCalculator::computeUncoveredRegions(std::vector<Input_Point> &tour, bool interpret_as_path) {
 
-        auto covered_polygons = this->compute_covered_polygon(tour, interpret_as_path);
+        auto tour_polygons = this->compute_tour_polygons(tour, interpret_as_path);
+
+        if (this->is_coverage_certified(tour_polygons)) {
+            if (verbose) {
+                std::cout << "Coverage certified with circle-segment offsets" << std::endl;
+            }
+            this->polygon_set.clear();
+            for (auto &tile: this->tiles) {
+                tile.polygon_set.clear();
+                tile.initialized = true;
+            }
+            return;
+        }
+
+        if (!this->tiles.empty()) {
+            this->compute_tiled_difference(tour_polygons);
+            return;
+        }
+
+        auto covered_polygons = this->compute_covered_polygon(tour_polygons);
 
         for (auto &covered_polygon: covered_polygons) {
             if (verbose) {
@@ -83,14 +121,246 @@ namespace mowing {
     }
 
 
+    void ExactOffsetCalculator::subtractAddedSubtours(std::vector<std::vector<Input_Point>> &subtours) {
+        for (auto &subtour: subtours) {
+            // A single point does not add anything to the coverage of the tour
+            if (std::all_of(subtour.begin(), subtour.end(), [&subtour](auto &p) { return p == subtour.front(); })) {
+                continue;
+            }
+            this->computeUncoveredRegions(subtour);
+        }
+    }
+
+
     void ExactOffsetCalculator::initializeUncoveredRegions() {
         this->polygon_set = Polygon_set_2();
         this->polygon_set.insert(this->base_polygon);
+
+        if (this->circle_segment_fast_path) {
+            this->circle_segment_polygon_set = Circle_segment_polygon_set_2();
+            this->circle_segment_polygon_set.insert(this->circle_segment_base_polygon);
+            this->circle_segment_polygon_set_valid = true;
+        }
+
+        for (auto &tile: this->tiles) {
+            tile.polygon_set = Polygon_set_2();
+            tile.initialized = false;
+        }
     }
 
+    void ExactOffsetCalculator::enableTiling(std::size_t tiles_x, std::size_t tiles_y, unsigned num_threads) {
+        this->num_threads = std::max(1u, num_threads);
+        this->tiles.clear();
+
+        if (tiles_x * tiles_y > 1) {
+            auto xmin = std::numeric_limits<double>::infinity(), xmax = -xmin;
+            auto ymin = xmin, ymax = xmax;
+            for (auto &[x, y]: this->input_vertices) {
+                xmin = std::min(xmin, x);
+                xmax = std::max(xmax, x);
+                ymin = std::min(ymin, y);
+                ymax = std::max(ymax, y);
+            }
+
+            // Neighboring tiles have to share exactly the same coordinates.
+            auto x_at = [&](std::size_t i) { return i == tiles_x ? xmax : xmin + i * (xmax - xmin) / tiles_x; };
+            auto y_at = [&](std::size_t j) { return j == tiles_y ? ymax : ymin + j * (ymax - ymin) / tiles_y; };
+            for (std::size_t i = 0; i < tiles_x; i++) {
+                for (std::size_t j = 0; j < tiles_y; j++) {
+                    this->tiles.push_back(Tile{x_at(i), y_at(j), x_at(i + 1), y_at(j + 1)});
+                }
+            }
+        }
+
+        this->initializeUncoveredRegions();
+    }
+
+    void ExactOffsetCalculator::initialize_tile(Tile &tile) {
+        Input_Linear_polygon polygon;
+        for (auto &[x, y]: this->input_vertices) {
+            polygon.push_back(Input_Point(x, y));
+        }
+
+        Input_Linear_polygon rectangle;
+        rectangle.push_back(Input_Point(tile.xmin, tile.ymin));
+        rectangle.push_back(Input_Point(tile.xmax, tile.ymin));
+        rectangle.push_back(Input_Point(tile.xmax, tile.ymax));
+        rectangle.push_back(Input_Point(tile.xmin, tile.ymax));
+
+        tile.polygon_set = Polygon_set_2();
+        tile.polygon_set.insert(this->convert_input_polygon(polygon));
+        tile.polygon_set.intersection(this->convert_input_polygon(rectangle));
+        tile.initialized = true;
+    }
+
+    void ExactOffsetCalculator::compute_tiled_difference(std::vector<Linear_polygon> &tour_polygons) {
+        // Only doubles are passed to the threads, as the exact numbers must not be shared. The coordinates of the
+        // tour polygons are doubles anyway.
+        std::vector<std::vector<std::pair<double, double>>> parts;
+        std::vector<std::vector<std::size_t>> parts_of_tile(this->tiles.size());
+
+        // The tiles reached by the offset of a polyline
+        auto reached_tiles = [this](const std::vector<std::pair<double, double>> &points) {
+            auto xmin = std::numeric_limits<double>::infinity(), xmax = -xmin;
+            auto ymin = xmin, ymax = xmax;
+            for (auto &[x, y]: points) {
+                xmin = std::min(xmin, x);
+                xmax = std::max(xmax, x);
+                ymin = std::min(ymin, y);
+                ymax = std::max(ymax, y);
+            }
+
+            std::vector<std::size_t> reached;
+            for (std::size_t t = 0; t < this->tiles.size(); t++) {
+                auto &tile = this->tiles[t];
+                if (xmin - radius <= tile.xmax && xmax + radius >= tile.xmin &&
+                    ymin - radius <= tile.ymax && ymax + radius >= tile.ymin) {
+                    reached.push_back(t);
+                }
+            }
+            return reached;
+        };
+
+        auto add_part = [&](std::vector<std::pair<double, double>> part, const std::vector<std::size_t> &reached) {
+            for (auto t: reached) {
+                parts_of_tile[t].push_back(parts.size());
+            }
+            parts.push_back(std::move(part));
+        };
+
+        // A polygon whose offset reaches a single tile is offset as a whole. Otherwise, every tile would compute
+        // the whole offset, so the polygon is split into its edges, whose offsets cover the same area. Every tile
+        // then only gets the edges close to it.
+        for (auto &tour_polygon: tour_polygons) {
+            std::vector<std::pair<double, double>> polygon;
+            for (auto it = tour_polygon.vertices_begin(); it != tour_polygon.vertices_end(); it++) {
+                polygon.emplace_back(CGAL::to_double(it->x()), CGAL::to_double(it->y()));
+            }
+
+            auto reached = reached_tiles(polygon);
+            if (reached.size() <= 1 || polygon.size() <= 2) {
+                add_part(std::move(polygon), reached);
+                continue;
+            }
+            for (std::size_t i = 0; i < polygon.size(); i++) {
+                auto edge = std::vector<std::pair<double, double>>{polygon[i], polygon[(i + 1) % polygon.size()]};
+                auto reached_by_edge = reached_tiles(edge);
+                add_part(std::move(edge), reached_by_edge);
+            }
+        }
+
+        std::atomic<std::size_t> next_tile{0};
+        std::vector<std::exception_ptr> errors(this->num_threads);
+        boost::thread_group tg;
+        for (unsigned thread = 0; thread < this->num_threads; thread++) {
+            tg.create_thread([&, thread]() {
+                try {
+                    for (auto t = next_tile++; t < this->tiles.size(); t = next_tile++) {
+                        auto &tile = this->tiles[t];
+                        if (!tile.initialized) {
+                            this->initialize_tile(tile);
+                        }
+
+                        for (auto i: parts_of_tile[t]) {
+                            auto tile_polygons = std::vector<Linear_polygon>(1);
+                            for (auto &[x, y]: parts[i]) {
+                                tile_polygons.back().push_back(Point(x, y));
+                            }
+                            for (auto &covered_polygon: this->compute_covered_polygon(tile_polygons)) {
+                                tile.polygon_set.difference(covered_polygon);
+                            }
+                        }
+                    }
+                } catch (...) {
+                    errors[thread] = std::current_exception();
+                }
+            });
+        }
+        tg.join_all();
+
+        for (auto &error: errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        // Stitch the tiles together, which merges the regions crossing tile boundaries.
+        this->polygon_set = Polygon_set_2();
+        for (auto &tile: this->tiles) {
+            this->polygon_set.join(tile.polygon_set);
+        }
+    }
+
+    /**
+     * Subtracts the coverage of the tour polygons from the circle-segment polygon set. The coverage is offset by
+     * a radius reduced by the approximation error, so it is contained in the exact coverage and the set always
+     * contains the exact uncovered regions.
+     * @return True if nothing is left uncovered, i.e., the exact difference would be empty as well.
+     */
+    bool ExactOffsetCalculator::is_coverage_certified(std::vector<Linear_polygon> &tour_polygons) {
+        if (!this->circle_segment_fast_path || !this->circle_segment_polygon_set_valid) {
+            return false;
+        }
+
+        try {
+            for (auto &tour_polygon: tour_polygons) {
+                if (!tour_polygon.is_simple()) {
+                    this->circle_segment_polygon_set_valid = false;
+                    return false;
+                }
+                this->circle_segment_polygon_set.difference(this->compute_inner_covered_polygon(tour_polygon));
+            }
+        } catch (std::exception &ex) {
+            // E.g., a degenerated polygon the approximation cannot handle. Use the conic traits from now on.
+            if (verbose) {
+                std::cout << "Circle-segment offset failed: " << ex.what() << std::endl;
+            }
+            this->circle_segment_polygon_set_valid = false;
+            return false;
+        }
+
+        return this->circle_segment_polygon_set.is_empty();
+    }
+
+    ExactOffsetCalculator::Circle_segment_polygon_with_holes_2
+    ExactOffsetCalculator::compute_inner_covered_polygon(Linear_polygon &tour_polygon) {
+        auto P = this->convert_to_input_polygon(tour_polygon);
+        if (P.is_clockwise_oriented()) {
+            P.reverse_orientation();
+        }
+
+        // With an error of at most epsilon, the boundaries are between the offsets by radius - 2 epsilon and
+        // radius. Thus, the offset is inside and the insets contain the exact ones.
+        InputKernel::FT inner_radius(this->radius - CIRCLE_SEGMENT_EPSILON);
+        auto covered_polygon = CGAL::approximated_offset_2(P, inner_radius, CIRCLE_SEGMENT_EPSILON);
+
+        if (P.area() > 0) {
+            std::vector<Circle_segment_polygon_2> inset_polygons;
+            CGAL::approximated_inset_2(P, inner_radius, CIRCLE_SEGMENT_EPSILON, std::back_inserter(inset_polygons));
+
+            for (auto &inset_polygon: inset_polygons) {
+                if (inset_polygon.orientation() == CGAL::COUNTERCLOCKWISE) {
+                    inset_polygon.reverse_orientation();
+                }
+                covered_polygon.add_hole(inset_polygon);
+            }
+        }
+
+        return covered_polygon;
+    }
+
+    ExactOffsetCalculator::Input_Linear_polygon
+    ExactOffsetCalculator::convert_to_input_polygon(Linear_polygon &polygon) {
+        Input_Linear_polygon P;
+        for (auto it = polygon.vertices_begin(); it != polygon.vertices_end(); it++) {
+            P.push_back(Input_Point(CGAL::to_double(it->x()), CGAL::to_double(it->y())));
+        }
+        return P;
+    }
 
-    std::vector<ExactOffsetCalculator::Polygon_with_holes_2>
-    ExactOffsetCalculator::compute_covered_polygon(std::vector<Input_Point> &points, bool interpret_as_path) {
+
+    std::vector<ExactOffsetCalculator::Linear_polygon>
+    ExactOffsetCalculator::compute_tour_polygons(std::vector<Input_Point> &points, bool interpret_as_path) {
 
         std::vector<Input_Point> tour(points.begin(), points.end());
 
@@ -114,11 +384,13 @@ namespace mowing {
         }
 
 
-        CGAL::Polygon_2<InputKernel> start_poly;
-        start_poly.insert(start_poly.vertices_begin(), tour.begin(), tour.end());
+        return this->extract_polygons(tour);
+    }
+
+    std::vector<ExactOffsetCalculator::Polygon_with_holes_2>
+    ExactOffsetCalculator::compute_covered_polygon(std::vector<Linear_polygon> &tour_polygons) {
 
         auto result = std::vector<Polygon_with_holes_2>();
-        auto tour_polygons = this->extract_polygons(tour);
 
         for (auto &tour_polygon: tour_polygons) {
 
@@ -158,7 +430,6 @@ namespace mowing {
                 result.push_back(covered_polygon);
             } else {
                 if (verbose) {
-                    std::cout << "START POLYGON " << start_poly << std::endl;
                     std::cout << "PARTS" << std::endl;
                     for (auto &t: tour_polygons) {
                         std::cout << t << std::endl;
@@ -236,30 +507,14 @@ namespace mowing {
 
             for (auto &val: polygons) {
 
-                std::vector<Point> subtour;
-
-                auto &edges = val.second;
-                subtour.push_back(edges.back().first);
-                edges.pop_back();
-
-                bool foundSuccessor = true;
-
-                while(foundSuccessor && !edges.empty()) {
-                    foundSuccessor = false;
-                    for(auto ptr = edges.begin(); ptr != edges.end(); ptr++) {
-                        if(ptr->first == subtour.back() || ptr->second == subtour.back()) {
-                            foundSuccessor = true;
-                            subtour.push_back(ptr->first == subtour.back()? ptr->second : ptr->first);
-                            edges.erase(ptr);
-                            break;
-                        }
-                    }
-                }
+                auto subtour = this->chain_edges(val.second);
 
                 mowing::utils::cleanup_tour(subtour);
                 tour_polygons.emplace_back(subtour.begin(), subtour.end());
 
-                std::cout << tour_polygons.back() <<std::endl;
+                if (verbose) {
+                    std::cout << tour_polygons.back() << std::endl;
+                }
             }
         }
 
@@ -275,31 +530,28 @@ namespace mowing {
             throw std::runtime_error("Strange tour occurance in exact offset calculation (no faces).");
         }
 
-        // Remove duplicate tours (first trying consecutive duplicates as they are more likely)
-        // auto unique_it = std::unique(tour_polygons.begin(), tour_polygons.end(), approximation::utils::equal<Linear_polygon>);
-        // tour_polygons.resize(std::distance(tour_polygons.begin(), unique_it));
-        // Now remove all remaining duplicates with n^2 runtime
-        for (auto it = tour_polygons.begin(); it != tour_polygons.end();) {
-
-            if(it->size() == 0) {
-                it = tour_polygons.erase(it);
-                continue;
-            }
+        // Remove empty and duplicate tours. Equal polygons (up to rotation) have the same order-independent
+        // hash, so only polygons within a bucket have to be compared.
+        auto unique_polygons = std::vector<Linear_polygon>();
+        auto buckets = std::unordered_map<std::size_t, std::vector<std::size_t>>();
+        for (auto &tour_polygon: tour_polygons) {
+            if (tour_polygon.size() == 0) continue;
 
-            bool hasDuplicate = false;
-            for (auto it2 = std::next(it); it2 != tour_polygons.end(); it2++) {
-                if (mowing::utils::equal(*it, *it2)) {
-                    hasDuplicate = true;
-                    break;
-                }
+            auto hash = tour_polygon.size();
+            for (auto it = tour_polygon.vertices_begin(); it != tour_polygon.vertices_end(); it++) {
+                hash += PointHash()(*it);
             }
 
-            if (hasDuplicate) {
-                it = tour_polygons.erase(it);
-            } else {
-                it++;
+            auto &bucket = buckets[hash];
+            auto is_duplicate = std::any_of(bucket.begin(), bucket.end(), [&](std::size_t i) {
+                return mowing::utils::equal(unique_polygons[i], tour_polygon);
+            });
+            if (!is_duplicate) {
+                bucket.push_back(unique_polygons.size());
+                unique_polygons.push_back(std::move(tour_polygon));
             }
         }
+        tour_polygons = std::move(unique_polygons);
 
         for (auto &poly: tour_polygons) {
             if (!poly.is_simple()) {
@@ -311,6 +563,44 @@ namespace mowing {
         return tour_polygons;
     }
 
+    std::size_t ExactOffsetCalculator::PointHash::operator()(const Point &p) const {
+        // The points are converted from doubles, so the doubles identify them.
+        auto h = std::hash<double>()(CGAL::to_double(p.x()));
+        return h ^ (std::hash<double>()(CGAL::to_double(p.y())) + 0x9e3779b9 + (h << 6) + (h >> 2));
+    }
+
+    /**
+     * Chains the boundary edges of a face to a closed tour, using an index from every point to its incident edges.
+     */
+    std::vector<ExactOffsetCalculator::Point>
+    ExactOffsetCalculator::chain_edges(std::vector<std::pair<Point, Point>> &edges) {
+        auto incident_edges = std::unordered_map<Point, std::vector<std::size_t>, PointHash>();
+        for (std::size_t i = 0; i < edges.size(); i++) {
+            incident_edges[edges[i].first].push_back(i);
+            incident_edges[edges[i].second].push_back(i);
+        }
+
+        auto used = std::vector<bool>(edges.size(), false);
+        std::vector<Point> subtour;
+        subtour.push_back(edges.back().first);
+        used.back() = true;
+
+        while (true) {
+            auto &candidates = incident_edges[subtour.back()];
+            // Used edges are removed lazily
+            while (!candidates.empty() && used[candidates.back()]) {
+                candidates.pop_back();
+            }
+            if (candidates.empty()) break;
+
+            auto &edge = edges[candidates.back()];
+            used[candidates.back()] = true;
+            subtour.push_back(edge.first == subtour.back() ? edge.second : edge.first);
+        }
+
+        return subtour;
+    }
+
     bool ExactOffsetCalculator::do_inset_calculation(Linear_polygon &tour) {
         typedef CGAL::Gps_circle_segment_traits_2<InputKernel> Approximation_Traits;
         typedef Approximation_Traits::Polygon_2 Approximation_Polygon_2;
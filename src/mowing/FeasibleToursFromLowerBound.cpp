@@ -13,7 +13,10 @@ namespace mowing {
                          time,
                          max_witness_size,
                          max_witness_size,
-                         solution.lb_solutions.size()), lower_bound_solution(solution) {}
+                         solution.lb_solutions.size()), lower_bound_solution(solution) {
+        // Every iteration ends with a tour covering the polygon.
+        this->enableCircleSegmentFastPath();
+    }
 
     FeasibleToursFromLowerBound::solution FeasibleToursFromLowerBound::solve() {
         auto result = solution{std::vector<solution_iteration>(),
@@ -33,6 +36,8 @@ namespace mowing {
         for (auto &lb_solution: this->lower_bound_solution.lb_solutions) {
             try {
                 tour = lb_solution.tour;
+                // The tour is only simplified before its coverage is subtracted, see addToursForRegions.
+                mowing::utils::cleanup_tour(tour);
                 all_witnesses = lb_solution.witnesses;
 
                 result.iterations.push_back(solution_iteration{
@@ -45,8 +50,15 @@ namespace mowing {
                 auto &iteration = result.iterations.back();
                 this->updateLowerBound(lb_solution.lower_bound);
 
+                // Only the first step subtracts the whole tour, later steps only the subtours added to it.
+                auto added_subtours = std::vector<PointVector>();
+                bool first_step = true;
+
                 do {
-                    auto uncovered = this->computeUncoveredRegions(tour);
+                    auto uncovered = first_step ? this->computeUncoveredRegions(tour)
+                                                : this->computeUncoveredRegions(added_subtours);
+                    first_step = false;
+                    added_subtours.clear();
                     iteration.steps.push_back(solution_step{PointVector(all_witnesses),
                                                             PointVector(tour),
                                                             uncovered, 0});
@@ -57,9 +69,7 @@ namespace mowing {
                     if (solved) {
                         this->updateUpperBound(tour);
                     } else {
-                        for (auto &region: uncovered) {
-                            this->addTourForRegion(tour, region, all_witnesses);
-                        }
+                        added_subtours = this->addToursForRegions(tour, uncovered, all_witnesses);
                     }
 
                     auto step_end_time = Clock::now();
@@ -1,5 +1,10 @@
 #include "mowing/LowerBoundSolver.h"
 
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <boost/thread/thread.hpp>
+
 namespace mowing {
 
 
@@ -10,6 +15,31 @@ namespace mowing {
                                        MowingSolver(polygon, initial_strategy, followup_strategy, radius,
                                                     time, max_witness_size_initial, max_witness_size, max_iterations){}
 
+    void LowerBoundSolver::enablePortfolio(const std::vector<int> &followup_strategies, unsigned num_threads) {
+        if (this->raster_estimator) {
+            throw std::invalid_argument("The portfolio cannot be combined with the raster estimation");
+        }
+        this->portfolio.clear();
+        for (auto strategy: followup_strategies) {
+            this->portfolio.push_back(PortfolioMember{
+                    strategy,
+                    createFollowupStrategy(strategy, this->straight_line_polygon, this->radius),
+                    std::make_unique<KMeansSparsification>(this->cetsp_threads)});
+            this->portfolio.push_back(PortfolioMember{
+                    strategy,
+                    createFollowupStrategy(strategy, this->straight_line_polygon, this->radius),
+                    std::make_unique<DispersionSparsification>()});
+        }
+        this->portfolio_threads = num_threads;
+    }
+
+    void LowerBoundSolver::enableRasterEstimation(std::size_t resolution) {
+        if (!this->portfolio.empty()) {
+            throw std::invalid_argument("The raster estimation cannot be combined with the portfolio");
+        }
+        MowingSolver::enableRasterEstimation(resolution);
+    }
+
     LowerBoundSolver::solution LowerBoundSolver::solve() {
         auto result = solution{this->straight_line_polygon,
                                this->radius,
@@ -24,6 +54,7 @@ namespace mowing {
             for (std::size_t i = 0; i < this->max_iterations; i++) {
                 auto centroids = PointVector();
                 auto iteration_witnesses = PointVector();
+                auto portfolio_solution = std::optional<lower_bound_solution>();
 
                 int strategy = i == 0 ? this->initial_strategy_code : this->followup_strategy_code;
 
@@ -35,42 +66,83 @@ namespace mowing {
                     auto tour = result.lb_solutions.back().tour_after_tsp.empty() ? result.lb_solutions.back().tour :
                                 result.lb_solutions.back().tour_after_tsp;
 
-                    auto uncovered = this->computeUncoveredRegions(tour);
-                    auto witness_counts_for_region = calculateWitnessCountsForRegions(uncovered, this->max_witness_size);
+                    // Uncovered cells are certainly uncovered, so the exact regions are only needed without them.
+                    auto estimate = this->raster_estimator ? this->raster_estimator->estimate(tour)
+                                                           : RasterCoverageEstimator::Estimate();
+                    if (!estimate.isProbablyCovered()) {
+                        auto witness_counts_for_region = calculateWitnessCountsForRegions(estimate.regions,
+                                                                                          this->max_witness_size);
+
+                        for (std::size_t j = 0; j < estimate.regions.size(); j++) {
+                            auto &region = estimate.regions[j];
+                            std::size_t witness_count = witness_counts_for_region[j];
+                            auto outline = this->raster_estimator->outerBoundary(region);
+                            auto boundary = this->offset_calculator->convert_input_polygon(outline);
+                            auto witnesses = PointVector();
+                            this->followup_strategy->placeWitnesses(witnesses, witness_count, boundary);
+
+                            // The cells may stick out of the polygon, but all witnesses have to be inside.
+                            witnesses.erase(std::remove_if(witnesses.begin(), witnesses.end(), [this](auto &p) {
+                                return this->straight_line_polygon.bounded_side(p) == CGAL::ON_UNBOUNDED_SIDE;
+                            }), witnesses.end());
+                            if (witnesses.empty()) {
+                                witnesses = this->raster_estimator->placeWitnesses(region, witness_count);
+                            }
 
-                    for (std::size_t j = 0; j < uncovered.size(); j++) {
-                        auto &region = uncovered[j];
-                        std::size_t witness_count = witness_counts_for_region[j];
-                        auto boundary = region.outer_boundary();
-                        auto witnesses = PointVector();
-                        this->followup_strategy->placeWitnesses(witnesses, witness_count, boundary);
+                            iteration_witnesses.insert(iteration_witnesses.end(), witnesses.begin(), witnesses.end());
 
-                        // Add witnesses to iteration
-                        iteration_witnesses.insert(iteration_witnesses.end(), witnesses.begin(), witnesses.end());
+                            auto current_centroids = this->followup_sparsification->sparsify(witnesses, witness_count, boundary);
+                            if (current_centroids) {
+                                centroids.insert(centroids.end(), current_centroids->begin(), current_centroids->end());
+                            }
 
-                        // Sparsification, save centroids if needed
-                        auto current_centroids = this->followup_sparsification->sparsify(witnesses, witness_count, boundary);
-                        if (current_centroids) {
-                            centroids.insert(centroids.end(), current_centroids->begin(), current_centroids->end());
+                            all_witnesses.insert(all_witnesses.end(), witnesses.begin(), witnesses.end());
                         }
+                    } else if (!this->portfolio.empty()) {
+                        auto uncovered = this->computeUncoveredRegions(tour);
+                        portfolio_solution = this->solvePortfolio(uncovered, all_witnesses);
+                    } else {
+                        auto uncovered = this->computeUncoveredRegions(tour);
+                        auto witness_counts_for_region = calculateWitnessCountsForRegions(uncovered, this->max_witness_size);
 
-                        // Add witnesses to all witnesses.
-                        all_witnesses.insert(all_witnesses.end(), witnesses.begin(), witnesses.end());
+                        for (std::size_t j = 0; j < uncovered.size(); j++) {
+                            auto &region = uncovered[j];
+                            std::size_t witness_count = witness_counts_for_region[j];
+                            auto boundary = region.outer_boundary();
+                            auto witnesses = PointVector();
+                            this->followup_strategy->placeWitnesses(witnesses, witness_count, boundary);
+
+                            // Add witnesses to iteration
+                            iteration_witnesses.insert(iteration_witnesses.end(), witnesses.begin(), witnesses.end());
+
+                            // Sparsification, save centroids if needed
+                            auto current_centroids = this->followup_sparsification->sparsify(witnesses, witness_count, boundary);
+                            if (current_centroids) {
+                                centroids.insert(centroids.end(), current_centroids->begin(), current_centroids->end());
+                            }
+
+                            // Add witnesses to all witnesses.
+                            all_witnesses.insert(all_witnesses.end(), witnesses.begin(), witnesses.end());
+                        }
                     }
 
                     std::cout << all_witnesses.size() << " witness size" << std::endl;
                 }
 
-                result.lb_solutions.emplace_back(lower_bound_solution{
-                        0,
-                        0,
-                        strategy,
-                        PointVector(all_witnesses),
-                        PointVector(centroids),
-                        PointVector(iteration_witnesses),
-                        PointVector(),
-                        PointVector(), false, 0});
-                this->getOptimalCETSPTour(result.lb_solutions.back());
+                if (portfolio_solution) {
+                    result.lb_solutions.push_back(std::move(*portfolio_solution));
+                } else {
+                    result.lb_solutions.emplace_back(lower_bound_solution{
+                            0,
+                            0,
+                            strategy,
+                            PointVector(all_witnesses),
+                            PointVector(centroids),
+                            PointVector(iteration_witnesses),
+                            PointVector(),
+                            PointVector(), false, 0});
+                    this->getOptimalCETSPTour(result.lb_solutions.back());
+                }
                 result.lower_bound = this->getLowerBound();
                 this->offset_calculator->initializeUncoveredRegions();
             }
@@ -91,10 +163,91 @@ namespace mowing {
         return result;
     }
 
-    void LowerBoundSolver::getOptimalCETSPTour(lower_bound_solution &lb_solution) {
+    LowerBoundSolver::lower_bound_solution
+    LowerBoundSolver::solvePortfolio(ConicPolygonVector &uncovered, PointVector &all_witnesses) {
+        auto witness_counts_for_region = calculateWitnessCountsForRegions(uncovered, this->max_witness_size);
+
+        // The witnesses are placed on this thread, as the conic regions must not be shared between threads.
+        auto candidates = std::vector<lower_bound_solution>();
+        auto exact_witnesses = std::vector<PointVector>();
+        for (auto &member: this->portfolio) {
+            auto witnesses = PointVector(all_witnesses);
+            auto centroids = PointVector();
+            auto iteration_witnesses = PointVector();
+
+            for (std::size_t j = 0; j < uncovered.size(); j++) {
+                std::size_t witness_count = witness_counts_for_region[j];
+                auto boundary = uncovered[j].outer_boundary();
+                auto region_witnesses = PointVector();
+                member.placement->placeWitnesses(region_witnesses, witness_count, boundary);
+                iteration_witnesses.insert(iteration_witnesses.end(), region_witnesses.begin(), region_witnesses.end());
+
+                auto current_centroids = member.sparsification->sparsify(region_witnesses, witness_count, boundary);
+                if (current_centroids) {
+                    centroids.insert(centroids.end(), current_centroids->begin(), current_centroids->end());
+                }
+                witnesses.insert(witnesses.end(), region_witnesses.begin(), region_witnesses.end());
+            }
+
+            // Only doubles are passed to the threads, as the exact numbers must not be shared. The exact witnesses
+            // are kept for the next iterations.
+            auto rounded_witnesses = PointVector();
+            for (auto &w: witnesses) {
+                rounded_witnesses.emplace_back(CGAL::to_double(w.x()), CGAL::to_double(w.y()));
+            }
+            exact_witnesses.push_back(std::move(witnesses));
+
+            candidates.emplace_back(lower_bound_solution{
+                    0,
+                    0,
+                    member.strategy,
+                    rounded_witnesses,
+                    centroids,
+                    iteration_witnesses,
+                    PointVector(),
+                    PointVector(), false, 0});
+        }
+
+        // The candidates share the threads equally. The lower bound is updated by every candidate.
+        auto num_threads = this->portfolio_threads != 0 ? this->portfolio_threads
+                                                        : std::max(1u, std::thread::hardware_concurrency());
+        auto member_threads = std::max(1u, num_threads / (unsigned) candidates.size());
+
+        std::vector<std::exception_ptr> errors(candidates.size());
+        boost::thread_group tg;
+        for (std::size_t c = 0; c < candidates.size(); c++) {
+            tg.create_thread([&, c]() {
+                try {
+                    this->getOptimalCETSPTour(candidates[c], member_threads);
+                } catch (...) {
+                    errors[c] = std::current_exception();
+                }
+            });
+        }
+        tg.join_all();
+
+        auto best = std::optional<std::size_t>();
+        for (std::size_t c = 0; c < candidates.size(); c++) {
+            if (!errors[c] && (!best || candidates[c].lower_bound > candidates[*best].lower_bound)) {
+                best = c;
+            }
+        }
+        if (!best) {
+            std::rethrow_exception(errors.front());
+        }
+
+        std::cout << "Portfolio candidate " << *best << " with strategy " << candidates[*best].strategy
+                  << " yields the best lower bound " << candidates[*best].lower_bound << std::endl;
+
+        all_witnesses = exact_witnesses[*best];
+        candidates[*best].witnesses = std::move(exact_witnesses[*best]);
+        return std::move(candidates[*best]);
+    }
+
+    void LowerBoundSolver::getOptimalCETSPTour(lower_bound_solution &lb_solution, unsigned num_threads) {
 
         try{
-            auto solution = this->calculateCETSPWithTSP(lb_solution.witnesses);
+            auto solution = this->calculateCETSPWithTSP(lb_solution.witnesses, num_threads);
 
             lb_solution.tour = solution.tour;
             lb_solution.tour_after_tsp = solution.tour_after_tsp;
@@ -105,6 +258,7 @@ namespace mowing {
             lb_solution.cetsp_time = solution.cetsp_time;
             lb_solution.lower_bound = solution.lower_bound;
             lb_solution.optimal = solution.optimal;
+            lb_solution.cetsp_statistics = solution.cetsp_statistics;
         } catch (MowingSolver::MowingSolverCETSPException &ex) {
             this->updateLowerBound(ex.getPartialSolution().lower_bound);
             throw ex;
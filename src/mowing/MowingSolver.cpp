@@ -29,20 +29,7 @@ namespace mowing {
                                          " is not implemented");
         }
 
-        switch (followup_strategy) {
-            case mowing::definitions::FOLLOWUP_STRATEGY_SKELETON:
-                this->followup_strategy = std::make_unique<StraightSkeletonPlacementStrategy>(polygon, radius);
-                break;
-            case mowing::definitions::FOLLOWUP_STRATEGY_GRID:
-                this->followup_strategy = std::make_unique<GridPlacementStrategy>(polygon, radius);
-                break;
-            case mowing::definitions::FOLLOWUP_STRATEGY_RANDOM:
-                this->followup_strategy = std::make_unique<RandomPlacementStrategy>(polygon, radius);
-                break;
-            default:
-                throw std::runtime_error("The given strategy " + std::to_string(followup_strategy) +
-                                         " is not implemented");
-        }
+        this->followup_strategy = createFollowupStrategy(followup_strategy, polygon, radius);
 
         this->initial_sparsification = std::make_unique<DispersionSparsification>();
         this->followup_sparsification = std::make_unique<KMeansSparsification>();
@@ -57,13 +44,61 @@ namespace mowing {
         this->time = time;
     }
 
+    /**
+     * Creates the followup witness placement strategy for the given code.
+     * @param followup_strategy One of the FOLLOWUP_STRATEGY_* codes.
+     * @param polygon The polygon to be covered.
+     * @param radius The radius of the cutter.
+     * @return The placement strategy.
+     */
+    std::unique_ptr<WitnessPlacementStrategy>
+    MowingSolver::createFollowupStrategy(int followup_strategy, Polygon_2 &polygon, double radius) {
+        switch (followup_strategy) {
+            case mowing::definitions::FOLLOWUP_STRATEGY_SKELETON:
+                return std::make_unique<StraightSkeletonPlacementStrategy>(polygon, radius);
+            case mowing::definitions::FOLLOWUP_STRATEGY_GRID:
+                return std::make_unique<GridPlacementStrategy>(polygon, radius);
+            case mowing::definitions::FOLLOWUP_STRATEGY_RANDOM:
+                return std::make_unique<RandomPlacementStrategy>(polygon, radius);
+            default:
+                throw std::runtime_error("The given strategy " + std::to_string(followup_strategy) +
+                                         " is not implemented");
+        }
+    }
+
     /**
      * Initializes the offset calculator. Note that the offset calculator must be reset for consecutive queries.
      * It preserves the uncovered regions otherwise.
      */
     void MowingSolver::initializeOffsetCalculator() {
         this->offset_calculator = std::make_unique<mowing::ExactOffsetCalculator>(this->straight_line_polygon,
-                                                                                  this->radius + 1e-3, false);
+                                                                                  this->radius + 1e-3, false,
+                                                                                  this->circle_segment_fast_path);
+        if (this->offset_tiles_per_axis > 1) {
+            this->offset_calculator->enableTiling(this->offset_tiles_per_axis, this->offset_tiles_per_axis,
+                                                  this->offset_tiling_threads);
+        }
+    }
+
+    void MowingSolver::enableRasterEstimation(std::size_t resolution) {
+        this->raster_estimator = std::make_unique<mowing::RasterCoverageEstimator>(this->straight_line_polygon,
+                                                                                   this->radius + 1e-3, resolution);
+    }
+
+    void MowingSolver::setOffsetTiling(std::size_t tiles_per_axis, unsigned num_threads) {
+        this->offset_tiles_per_axis = tiles_per_axis;
+        this->offset_tiling_threads = num_threads;
+        this->offset_calculator->enableTiling(tiles_per_axis, tiles_per_axis, num_threads);
+    }
+
+    void MowingSolver::enableCircleSegmentFastPath() {
+        this->circle_segment_fast_path = true;
+        this->initializeOffsetCalculator();
+    }
+
+    void MowingSolver::setCETSPThreads(unsigned num_threads) {
+        this->cetsp_threads = num_threads;
+        this->followup_sparsification = std::make_unique<KMeansSparsification>(num_threads);
     }
 
     /**
@@ -80,6 +115,20 @@ namespace mowing {
         return result;
     }
 
+    /**
+     * Computes the uncovered regions after extending a tour whose regions have already been computed.
+     * @param added_subtours The closed subtours that have been inserted into the tour.
+     * @return The remaining regions after removing the Minkowski Sum of the subtours and the cutter.
+     */
+    MowingSolver::ConicPolygonVector
+    MowingSolver::computeUncoveredRegions(std::vector<PointVector> &added_subtours) {
+        this->offset_calculator->subtractAddedSubtours(added_subtours);
+
+        auto result = ExactOffsetCalculator::ConicPolygonVector();
+        this->offset_calculator->polygon_set.polygons_with_holes(std::back_inserter(result));
+        return result;
+    }
+
     /**
      * To allow a constant amount of witnesses to be placed it might be necessary to distribute the witnesses
      * across all uncovered regions. This method distributes depending on the region sizes.
@@ -89,14 +138,9 @@ namespace mowing {
      */
     std::map<std::size_t, std::size_t>
     MowingSolver::calculateWitnessCountsForRegions(ConicPolygonVector &polygons, std::size_t n) {
-        std::random_device rd;
-        std::mt19937 gen(rd());
         std::vector<double> probabilities;
-        std::map<std::size_t, std::size_t> counts;
 
-        int idx = 0;
         for (auto &region: polygons) {
-            counts[idx++] = 0;
             Polygon_2 poly = mowing::utils::approximate_polygon(region.outer_boundary());
 
             if (poly.is_simple()) {
@@ -109,7 +153,40 @@ namespace mowing {
                 probabilities.emplace_back(1);
             }
         }
-        std::discrete_distribution<> d(probabilities.begin(), probabilities.end());
+
+        return calculateWitnessCountsForAreas(probabilities, n);
+    }
+
+    /**
+     * Distributes the witnesses across the uncovered regions estimated on the grid depending on their areas.
+     */
+    std::map<std::size_t, std::size_t>
+    MowingSolver::calculateWitnessCountsForRegions(const std::vector<RasterCoverageEstimator::Region> &regions,
+                                                   std::size_t n) {
+        std::vector<double> areas;
+        for (auto &region: regions) {
+            areas.emplace_back(region.area);
+        }
+
+        return calculateWitnessCountsForAreas(areas, n);
+    }
+
+    /**
+     * Draws the region of every witness with a probability proportional to its area.
+     * @param areas The areas of the regions.
+     * @param n The total amount of witnesses.
+     * @return A map of the form <index, count> that assigns a count to a region with SUM(c for all _, c in map)==n
+     */
+    std::map<std::size_t, std::size_t>
+    MowingSolver::calculateWitnessCountsForAreas(const std::vector<double> &areas, std::size_t n) {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::map<std::size_t, std::size_t> counts;
+
+        for (std::size_t idx = 0; idx < areas.size(); idx++) {
+            counts[idx] = 0;
+        }
+        std::discrete_distribution<> d(areas.begin(), areas.end());
         for (std::size_t i = 0; i < n; ++i) {
             ++counts[d(gen)];
         }
@@ -122,9 +199,10 @@ namespace mowing {
      * @param witnesses The witness set.
      * @return A CETSP solution.
      */
-    MowingSolver::cetsp_extended_solution MowingSolver::calculateCETSPWithTSP(PointVector &witnesses) {
+    MowingSolver::cetsp_extended_solution MowingSolver::calculateCETSPWithTSP(PointVector &witnesses,
+                                                                              unsigned num_threads) {
         auto empty_start = std::shared_ptr<Point>();
-        return this->calculateCETSPWithTSP(witnesses, empty_start);
+        return this->calculateCETSPWithTSP(witnesses, empty_start, num_threads);
     }
 
     /**
@@ -135,14 +213,17 @@ namespace mowing {
      * a start point can be set.
      * @param witnesses The witnesses
      * @param start_point The start point of the tour. Can be empty.
+     * @param num_threads The number of threads of the CETSP solver, the default of the solver if 0.
      * @return A CETSP solution
      */
     MowingSolver::cetsp_extended_solution
-    MowingSolver::calculateCETSPWithTSP(PointVector &witnesses, [[maybe_unused]] std::shared_ptr<Point> &start_point) {
+    MowingSolver::calculateCETSPWithTSP(PointVector &witnesses, [[maybe_unused]] std::shared_ptr<Point> &start_point,
+                                        unsigned num_threads) {
 
         // Solve CETSP and measure the time
         auto startTimeSolver = Clock::now();
-        auto solution = cetsp::solve(witnesses, start_point, this->radius, this->time);
+        auto solution = cetsp::solve(witnesses, start_point, this->radius, this->time, false,
+                                     num_threads != 0 ? num_threads : this->cetsp_threads);
 
         auto endTimeSolver = Clock::now();
         auto &tour = solution.points;
@@ -154,7 +235,8 @@ namespace mowing {
                 PointVector(tour),
                 PointVector(),
                 solution.optimal_solution_found,
-                solution.lower_bound};
+                solution.lower_bound,
+                solution.statistics};
 
         if (tour.empty()) {
             throw MowingSolverCETSPException("CETSP yielded an empty tour.", extended_solution);
@@ -203,6 +285,7 @@ namespace mowing {
     }
 
     void MowingSolver::updateLowerBound(const Kernel::FT &lb) {
+        std::lock_guard<std::mutex> lock(this->bounds_mutex);
         this->lower_bound = CGAL::max(lb, this->lower_bound);
     }
 
@@ -1,5 +1,10 @@
 #include "mowing/MowingSolverWithUpperBound.h"
 
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <boost/thread/thread.hpp>
+
 
 namespace mowing {
 
@@ -18,7 +23,11 @@ namespace mowing {
                          max_witness_size_initial,
                          max_witness_size,
                          max_iterations), upper_bound(std::move(upper_bound)) {
+        this->region_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
 
+    void MowingSolverWithUpperBound::setRegionThreads(unsigned num_threads) {
+        this->region_threads = std::max(1u, num_threads);
     }
 
     MowingSolverWithUpperBound::ShortestConnectingSegmentResult
@@ -26,58 +35,120 @@ namespace mowing {
         return mowing::utils::shortest_connecting_segment(tour, region);
     }
 
-    void MowingSolverWithUpperBound::addTourForRegion(PointVector &tour,
-                                                      Conic_Polygon_with_holes_2 &region,
-                                                      PointVector &all_witnesses) {
+    std::vector<MowingSolverWithUpperBound::PointVector>
+    MowingSolverWithUpperBound::addToursForRegions(PointVector &tour, ConicPolygonVector &regions,
+                                                   PointVector &all_witnesses) {
+        auto start_points = PointVector();
+        auto witnesses = std::vector<PointVector>();
+
+        // All regions connect to the tour before any subtour is inserted, such that they are independent.
+        for (auto &region: regions) {
+            auto shortest_segment = this->getShortestConnectingSegment(tour, region).first;
+            start_points.push_back(shortest_segment->source());
+            witnesses.push_back(this->placeWitnessesForConic(region.outer_boundary(), all_witnesses));
+        }
 
-        auto shortest_connecting_result = this->getShortestConnectingSegment(tour, region);
+        // Only doubles are passed to the threads, as the exact numbers must not be shared.
+        for (auto &region_witnesses: witnesses) {
+            for (auto &w: region_witnesses) {
+                w = Point(CGAL::to_double(w.x()), CGAL::to_double(w.y()));
+            }
+        }
+        auto thread_start_points = std::vector<std::shared_ptr<Point>>();
+        for (auto &p: start_points) {
+            thread_start_points.push_back(std::make_shared<Point>(CGAL::to_double(p.x()), CGAL::to_double(p.y())));
+        }
 
-        auto shortest_segment = shortest_connecting_result.first;
-        auto edge_to_replace = shortest_connecting_result.second;
+        // Every thread solves whole regions with its own CETSP and TSP solvers. The bounds are updated under a lock.
+        auto subtours = std::vector<PointVector>(regions.size());
+        auto num_threads = std::min<std::size_t>(this->region_threads, regions.size());
+        // The CETSP solvers of the threads share the threads the CETSP solver would use otherwise.
+        const auto total_cetsp_threads = this->cetsp_threads != 0 ? this->cetsp_threads :
+                                         std::max(1u, std::thread::hardware_concurrency());
+        const auto cetsp_threads_per_region = std::max(1u, total_cetsp_threads / (unsigned) num_threads);
+        std::atomic<std::size_t> next_region{0};
+        std::vector<std::exception_ptr> errors(num_threads);
+        boost::thread_group tg;
+        for (std::size_t thread = 0; thread < num_threads; thread++) {
+            tg.create_thread([&, thread]() {
+                try {
+                    for (auto i = next_region++; i < regions.size(); i = next_region++) {
+                        subtours[i] = this->calculateCETSPWithTSPAndUpdateBounds(witnesses[i],
+                                                                                 thread_start_points[i],
+                                                                                 cetsp_threads_per_region);
+                    }
+                } catch (...) {
+                    errors[thread] = std::current_exception();
+                }
+            });
+        }
+        tg.join_all();
 
-        auto start_point = std::make_shared<Point>(shortest_segment->source());
+        for (auto &error: errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
 
-        auto subtour = this->computeTourForConic(region.outer_boundary(),
-                                                 all_witnesses,
-                                                 start_point);
+        auto added_subtours = std::vector<PointVector>();
+        for (std::size_t i = 0; i < regions.size(); i++) {
+            added_subtours.push_back(insertSubtour(tour, subtours[i], start_points[i]));
+        }
+
+        // Only the duplicates are removed. Removing collinear points may cut off the tip of a spike, and the
+        // uncovered regions are only updated by the added subtours, not by coverage lost elsewhere.
+        mowing::utils::remove_duplicate_points(tour);
+        return added_subtours;
+    }
+
+    MowingSolverWithUpperBound::PointVector
+    MowingSolverWithUpperBound::insertSubtour(PointVector &tour, PointVector &subtour, const Point &start_point) {
+        if (subtour.empty() || tour.empty()) return {};
 
         long start_index = 0;
 
         // Find index of the splitting point in the subtour (might be slightly different due to double precision)
         for (long i = 0; i < (long) subtour.size(); i++) {
-            if (CGAL::has_smaller_distance_to_point(shortest_segment->source(), subtour[i], subtour[start_index])) {
+            if (CGAL::has_smaller_distance_to_point(start_point, subtour[i], subtour[start_index])) {
                 start_index = i;
             }
         }
 
         // Modify vector so that start vector is at front
         std::rotate(subtour.begin(), subtour.begin() + start_index, subtour.end());
-        subtour[0] = *start_point;
+        subtour[0] = start_point;
 
-        for (auto it = tour.begin(); it != tour.end(); it++) {
+        auto vertex = std::find(tour.begin(), tour.end(), start_point);
+        if (vertex != tour.end()) {
+            tour.insert(vertex, subtour.begin(), subtour.end());
+            subtour.emplace_back(start_point);
+            return subtour;
+        }
 
+        // The start point is on an edge of the tour, which is the closest one (the edge may have been split).
+        auto edge = tour.begin();
+        auto edge_distance = Kernel::FT(-1);
+        for (auto it = tour.begin(); it != tour.end(); it++) {
             auto next = it + 1;
             if (next == tour.end()) next = tour.begin();
+            if (*it == *next) continue;
 
-            if (edge_to_replace == nullptr) {
-                if (*it == shortest_segment->source()) {
-                    tour.insert(it, subtour.begin(), subtour.end());
-                    break;
-                }
-            } else if (*it == edge_to_replace->first && *next == edge_to_replace->second) {
-                subtour.emplace_back(*start_point);
-                tour.insert(next, subtour.begin(), subtour.end());
-                break;
+            auto distance = CGAL::squared_distance(Segment(*it, *next), start_point);
+            if (edge_distance < 0 || distance < edge_distance) {
+                edge = it;
+                edge_distance = distance;
             }
         }
+        if (edge_distance < 0) return {};
 
-        mowing::utils::cleanup_tour(tour);
+        // The tour only gains the closed subtour.
+        subtour.emplace_back(start_point);
+        tour.insert(edge + 1, subtour.begin(), subtour.end());
+        return subtour;
     }
 
     MowingSolverWithUpperBound::PointVector
-    MowingSolverWithUpperBound::computeTourForConic(const ConicPolygon &P,
-                                                    PointVector &all_witnesses,
-                                                    std::shared_ptr<Point> &start_point) {
+    MowingSolverWithUpperBound::placeWitnessesForConic(const ConicPolygon &P, PointVector &all_witnesses) {
         auto witnesses = PointVector();
 
         // Add witnesses, sparsify them afterward
@@ -87,16 +158,16 @@ namespace mowing {
         // Add witnesses to all_witnesses for logging
         all_witnesses.insert(all_witnesses.end(), witnesses.begin(), witnesses.end());
 
-        // Calculate CETSP + TSP (if necessary) and return the shortest tour.
-        return this->calculateCETSPWithTSPAndUpdateBounds(witnesses, start_point);
+        return witnesses;
     }
 
     MowingSolverWithUpperBound::PointVector
     MowingSolverWithUpperBound::calculateCETSPWithTSPAndUpdateBounds(PointVector &witnesses,
-                                                                     std::shared_ptr<Point> &start_point) {
+                                                                     std::shared_ptr<Point> &start_point,
+                                                                     unsigned num_threads) {
         try {
             // Calculate CETSP. In case of an error we perform TSP
-            auto solution = this->calculateCETSPWithTSP(witnesses, start_point);
+            auto solution = this->calculateCETSPWithTSP(witnesses, start_point, num_threads);
 
             // Use the shorter tour.
             auto &tour =
@@ -136,6 +207,7 @@ namespace mowing {
     }
 
     void MowingSolverWithUpperBound::updateUpperBound(PointVector &solution) {
+        std::lock_guard<std::mutex> lock(this->bounds_mutex);
         this->upper_bound = CGAL::min(::utils::compute_tour_length(solution), this->upper_bound);
     }
 
@@ -0,0 +1,276 @@
+#include "mowing/RasterCoverageEstimator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace mowing {
+
+    RasterCoverageEstimator::RasterCoverageEstimator(Polygon_2 &polygon, double radius, std::size_t resolution) {
+        this->radius = radius;
+
+        auto bbox = polygon.bbox();
+        this->xmin = bbox.xmin();
+        this->ymin = bbox.ymin();
+        this->cell_size = std::max({bbox.xmax() - bbox.xmin(), bbox.ymax() - bbox.ymin(), 1e-9}) /
+                          (double) std::max<std::size_t>(resolution, 1);
+        this->width = (std::size_t) std::ceil((bbox.xmax() - bbox.xmin()) / this->cell_size) + 1;
+        this->height = (std::size_t) std::ceil((bbox.ymax() - bbox.ymin()) / this->cell_size) + 1;
+
+        this->rasterize_polygon(polygon);
+    }
+
+    std::pair<double, double> RasterCoverageEstimator::center(std::size_t cell) const {
+        return {this->xmin + ((double) (cell % this->width) + 0.5) * this->cell_size,
+                this->ymin + ((double) (cell / this->width) + 0.5) * this->cell_size};
+    }
+
+    /**
+     * Marks the cells whose center is inside the polygon with a scanline per row. The crossings are only
+     * computed with doubles, so the cells next to a crossing are decided with the exact predicate.
+     */
+    void RasterCoverageEstimator::rasterize_polygon(Polygon_2 &polygon) {
+        this->inside.assign(this->width * this->height, 0);
+
+        auto vertices = std::vector<std::pair<double, double>>();
+        for (auto it = polygon.vertices_begin(); it != polygon.vertices_end(); it++) {
+            vertices.emplace_back(CGAL::to_double(it->x()), CGAL::to_double(it->y()));
+        }
+
+        auto crossings = std::vector<double>();
+        for (std::size_t row = 0; row < this->height; row++) {
+            auto y = this->center(row * this->width).second;
+
+            crossings.clear();
+            for (std::size_t i = 0; i < vertices.size(); i++) {
+                auto &[ax, ay] = vertices[i];
+                auto &[bx, by] = vertices[(i + 1) % vertices.size()];
+                // Half-open to count vertices on the scanline only once
+                if ((ay <= y) != (by <= y)) {
+                    crossings.push_back(ax + (y - ay) / (by - ay) * (bx - ax));
+                }
+            }
+            std::sort(crossings.begin(), crossings.end());
+
+            for (std::size_t i = 0; i + 1 < crossings.size(); i += 2) {
+                auto first = (long) std::ceil((crossings[i] - this->xmin) / this->cell_size - 0.5);
+                auto last = (long) std::floor((crossings[i + 1] - this->xmin) / this->cell_size - 0.5);
+                for (auto col = std::max(first, 0L); col <= std::min(last, (long) this->width - 1); col++) {
+                    this->inside[row * this->width + col] = 1;
+                }
+            }
+
+            for (auto crossing: crossings) {
+                auto nearest = (long) std::floor((crossing - this->xmin) / this->cell_size - 0.5);
+                for (auto col = std::max(nearest - 1, 0L); col <= std::min(nearest + 2, (long) this->width - 1); col++) {
+                    auto cell = row * this->width + col;
+                    auto [cx, cy] = this->center(cell);
+                    this->inside[cell] = polygon.bounded_side(Point(cx, cy)) == CGAL::ON_BOUNDED_SIDE;
+                }
+            }
+        }
+    }
+
+    /**
+     * Marks all cells whose center is within the radius of the segment pq.
+     */
+    void RasterCoverageEstimator::rasterize_segment(std::vector<uint8_t> &covered, double px, double py,
+                                                    double qx, double qy) const {
+        auto to_col = [this](double x) { return (long) std::floor((x - this->xmin) / this->cell_size); };
+        auto to_row = [this](double y) { return (long) std::floor((y - this->ymin) / this->cell_size); };
+
+        auto col_begin = std::max(to_col(std::min(px, qx) - radius), 0L);
+        auto col_end = std::min(to_col(std::max(px, qx) + radius), (long) this->width - 1);
+        auto row_begin = std::max(to_row(std::min(py, qy) - radius), 0L);
+        auto row_end = std::min(to_row(std::max(py, qy) + radius), (long) this->height - 1);
+
+        auto dx = qx - px, dy = qy - py;
+        auto squared_length = dx * dx + dy * dy;
+        auto squared_radius = radius * radius;
+
+        for (auto row = row_begin; row <= row_end; row++) {
+            for (auto col = col_begin; col <= col_end; col++) {
+                auto cell = row * this->width + col;
+                if (covered[cell]) continue;
+
+                auto [x, y] = this->center(cell);
+                auto t = squared_length > 0 ? std::clamp(((x - px) * dx + (y - py) * dy) / squared_length, 0.0, 1.0)
+                                            : 0.0;
+                auto ex = px + t * dx - x, ey = py + t * dy - y;
+                if (ex * ex + ey * ey <= squared_radius) {
+                    covered[cell] = 1;
+                }
+            }
+        }
+    }
+
+    /**
+     * Approximates the distance of every cell to the covered cells with a two-pass chamfer transform.
+     */
+    std::vector<double> RasterCoverageEstimator::compute_distances(const std::vector<uint8_t> &covered) const {
+        const auto straight = this->cell_size;
+        const auto diagonal = this->cell_size * std::sqrt(2.0);
+        const auto w = (long) this->width, h = (long) this->height;
+
+        auto distances = std::vector<double>(covered.size(), std::numeric_limits<double>::infinity());
+        for (std::size_t cell = 0; cell < covered.size(); cell++) {
+            if (covered[cell]) distances[cell] = 0;
+        }
+
+        auto relax = [&](long row, long col, long nrow, long ncol, double weight) {
+            if (nrow < 0 || nrow >= h || ncol < 0 || ncol >= w) return;
+            auto &d = distances[row * w + col];
+            d = std::min(d, distances[nrow * w + ncol] + weight);
+        };
+
+        for (long row = 0; row < h; row++) {
+            for (long col = 0; col < w; col++) {
+                relax(row, col, row, col - 1, straight);
+                relax(row, col, row - 1, col - 1, diagonal);
+                relax(row, col, row - 1, col, straight);
+                relax(row, col, row - 1, col + 1, diagonal);
+            }
+        }
+        for (long row = h - 1; row >= 0; row--) {
+            for (long col = w - 1; col >= 0; col--) {
+                relax(row, col, row, col + 1, straight);
+                relax(row, col, row + 1, col + 1, diagonal);
+                relax(row, col, row + 1, col, straight);
+                relax(row, col, row + 1, col - 1, diagonal);
+            }
+        }
+
+        return distances;
+    }
+
+    RasterCoverageEstimator::Estimate
+    RasterCoverageEstimator::estimate(const PointVector &tour, bool interpret_as_path) const {
+        auto covered = std::vector<uint8_t>(this->width * this->height, 0);
+
+        for (std::size_t i = 0; i < tour.size(); i++) {
+            if (interpret_as_path && i + 1 == tour.size() && tour.size() > 1) break;
+            auto &p = tour[i];
+            auto &q = tour[(i + 1) % tour.size()];
+            this->rasterize_segment(covered, CGAL::to_double(p.x()), CGAL::to_double(p.y()),
+                                    CGAL::to_double(q.x()), CGAL::to_double(q.y()));
+        }
+
+        // The covered cells are within the radius of the tour, so the distance to the tour is at most that.
+        auto tour_distances = this->compute_distances(covered);
+        for (auto &d: tour_distances) {
+            d += this->radius;
+        }
+
+        auto result = Estimate{std::vector<Region>(), 0};
+        auto visited = std::vector<uint8_t>(covered.size(), 0);
+        auto stack = std::vector<std::size_t>();
+
+        for (std::size_t start = 0; start < covered.size(); start++) {
+            if (!this->inside[start] || covered[start] || visited[start]) continue;
+
+            // Collect the 4-connected uncovered component
+            auto region = Region{0, Point(0, 0), -1, std::vector<std::size_t>(), std::vector<double>()};
+            visited[start] = 1;
+            stack.push_back(start);
+            while (!stack.empty()) {
+                auto cell = stack.back();
+                stack.pop_back();
+                region.cells.push_back(cell);
+
+                auto col = cell % this->width, row = cell / this->width;
+                auto visit = [&](std::size_t next) {
+                    if (this->inside[next] && !covered[next] && !visited[next]) {
+                        visited[next] = 1;
+                        stack.push_back(next);
+                    }
+                };
+                if (col > 0) visit(cell - 1);
+                if (col + 1 < this->width) visit(cell + 1);
+                if (row > 0) visit(cell - this->width);
+                if (row + 1 < this->height) visit(cell + this->width);
+            }
+
+            for (auto cell: region.cells) {
+                region.distances.push_back(tour_distances[cell]);
+                if (tour_distances[cell] > region.farthest_distance) {
+                    region.farthest_distance = tour_distances[cell];
+                    auto [x, y] = this->center(cell);
+                    region.farthest_point = Point(x, y);
+                }
+            }
+            region.area = (double) region.cells.size() * this->cell_size * this->cell_size;
+            result.uncovered_area += region.area;
+            result.regions.push_back(std::move(region));
+        }
+
+        return result;
+    }
+
+    RasterCoverageEstimator::PointVector
+    RasterCoverageEstimator::placeWitnesses(const Region &region, std::size_t n) const {
+        auto witnesses = PointVector();
+
+        // Distance of every cell of the region to the tour and the witnesses placed so far
+        auto distances = region.distances;
+
+        for (std::size_t k = 0; k < std::min(n, region.cells.size()); k++) {
+            auto best = std::max_element(distances.begin(), distances.end()) - distances.begin();
+            auto [wx, wy] = this->center(region.cells[best]);
+            witnesses.emplace_back(wx, wy);
+
+            for (std::size_t i = 0; i < region.cells.size(); i++) {
+                auto [x, y] = this->center(region.cells[i]);
+                distances[i] = std::min(distances[i], std::hypot(x - wx, y - wy));
+            }
+        }
+
+        return witnesses;
+    }
+
+    Polygon_2 RasterCoverageEstimator::outerBoundary(const Region &region) const {
+        auto in_region = std::vector<uint8_t>(this->width * this->height, 0);
+        for (auto cell: region.cells) {
+            in_region[cell] = 1;
+        }
+        auto contains = [&](long col, long row) {
+            return col >= 0 && row >= 0 && col < (long) this->width && row < (long) this->height &&
+                   in_region[row * this->width + col];
+        };
+
+        // Directions +x, +y, -x, -y. The cell ahead on the left of a lattice vertex has the given offset of its
+        // lower left corner, the cell ahead on the right is the one ahead on the left of the next right turn.
+        const long dx[] = {1, 0, -1, 0}, dy[] = {0, 1, 0, -1};
+        const long left_col[] = {0, -1, -1, 0}, left_row[] = {0, 0, -1, -1};
+
+        // The lowest cell has no neighbor below, so the boundary passes its lower left corner towards +x.
+        auto start = *std::min_element(region.cells.begin(), region.cells.end());
+        const auto start_col = (long) (start % this->width), start_row = (long) (start / this->width);
+
+        auto boundary = Polygon_2();
+        auto col = start_col, row = start_row;
+        int direction = 0;
+        do {
+            col += dx[direction];
+            row += dy[direction];
+
+            // Keep the region on the left and turn right as early as possible, which follows the outer boundary.
+            auto right = (direction + 3) % 4;
+            int next;
+            if (contains(col + left_col[right], row + left_row[right])) {
+                next = right;
+            } else if (contains(col + left_col[direction], row + left_row[direction])) {
+                next = direction;
+            } else {
+                next = (direction + 1) % 4;
+            }
+
+            if (next != direction) {
+                boundary.push_back(Point(this->xmin + (double) col * this->cell_size,
+                                         this->ymin + (double) row * this->cell_size));
+                direction = next;
+            }
+        } while (col != start_col || row != start_row);
+
+        return boundary;
+    }
+}
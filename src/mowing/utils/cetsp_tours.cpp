@@ -33,7 +33,7 @@ namespace mowing::utils {
                             CGAL::Polygon_2<CGAL::Cartesian<CGAL::CORE_algebraic_number_traits::Rational>> &poly2);
 
         template<typename PointType>
-        void cleanup_tour(std::vector<PointType> &tour) {
+        void remove_duplicate_points(std::vector<PointType> &tour) {
             // Save the last point of the tour for the case that all points are removed.
             auto tour_end = tour.back();
 
@@ -48,6 +48,15 @@ namespace mowing::utils {
                 }
             }
 
+            if (tour.empty()) { // All tour points were the same, thus we add one point back.
+                tour.emplace_back(tour_end);
+            }
+        }
+
+        template<typename PointType>
+        void cleanup_tour(std::vector<PointType> &tour) {
+            remove_duplicate_points(tour);
+
             for (auto it = tour.begin(); it != tour.end();) {
                 if (tour.size() < 3) {
                     break;
@@ -67,23 +76,11 @@ namespace mowing::utils {
                 }
             }
 
-            for (auto it = tour.begin(); it != tour.end();) {
-                auto next = it + 1;
-                if (next == tour.end()) next = tour.begin();
-
-                if (*it == *next) {
-                    it = tour.erase(it);
-                } else {
-                    it++;
-                }
-            }
-
-
-            if (tour.empty()) { // All tour points were the same, thus we add one point back.
-                tour.emplace_back(tour_end);
-            }
+            remove_duplicate_points(tour);
         }
 
+        template void remove_duplicate_points(std::vector<Point> &tour);
+        template void remove_duplicate_points(std::vector<CGAL::Cartesian<Nt_traits::Rational>::Point_2> &tour);
         template void cleanup_tour(std::vector<Point> &tour);
         template void cleanup_tour(std::vector<CGAL::Cartesian<Nt_traits::Rational>::Point_2> &tour);
     }
@@ -1,5 +1,97 @@
 #include "mowing/witnesses/sparsification/DispersionSparsification.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <optional>
+
+namespace {
+    /**
+     * A uniform grid over the edges of a polygon for the squared distance of a point to the boundary.
+     * Only the cells around the point are searched, in rings of increasing size.
+     */
+    class BoundaryGrid {
+    public:
+        explicit BoundaryGrid(const Polygon_2 &polygon) {
+            for (auto it = polygon.edges_begin(); it != polygon.edges_end(); it++) {
+                edges.push_back({CGAL::to_double(it->source().x()), CGAL::to_double(it->source().y()),
+                                 CGAL::to_double(it->target().x()), CGAL::to_double(it->target().y())});
+            }
+
+            auto bbox = polygon.bbox();
+            xmin = bbox.xmin();
+            ymin = bbox.ymin();
+            // About one edge per cell
+            auto cells_per_axis = std::max(1.0, std::ceil(std::sqrt((double) edges.size())));
+            cell_size = std::max({bbox.xmax() - bbox.xmin(), bbox.ymax() - bbox.ymin(), 1e-9}) / cells_per_axis;
+            width = (long) std::floor((bbox.xmax() - xmin) / cell_size) + 1;
+            height = (long) std::floor((bbox.ymax() - ymin) / cell_size) + 1;
+
+            cells.resize(width * height);
+            for (std::size_t e = 0; e < edges.size(); e++) {
+                auto &[ax, ay, bx, by] = edges[e];
+                for (auto row = to_row(std::min(ay, by)); row <= to_row(std::max(ay, by)); row++) {
+                    for (auto col = to_col(std::min(ax, bx)); col <= to_col(std::max(ax, bx)); col++) {
+                        cells[row * width + col].push_back(e);
+                    }
+                }
+            }
+        }
+
+        [[nodiscard]] double squared_distance(double x, double y) const {
+            auto best = std::numeric_limits<double>::infinity();
+            auto row = to_row(y), col = to_col(x);
+
+            for (long ring = 0; ring <= std::max(width, height); ring++) {
+                // The cells of the ring are at least (ring - 1) * cell_size away.
+                auto bound = (double) std::max(ring - 1, 0L) * cell_size;
+                if (ring > 0 && best <= bound * bound) break;
+
+                for (auto r = row - ring; r <= row + ring; r++) {
+                    if (r < 0 || r >= height) continue;
+                    for (auto c = col - ring; c <= col + ring; c++) {
+                        if (c < 0 || c >= width) continue;
+                        if (std::max(std::abs(r - row), std::abs(c - col)) != ring) continue;
+
+                        for (auto e: cells[r * width + c]) {
+                            best = std::min(best, squared_distance_to_edge(edges[e], x, y));
+                        }
+                    }
+                }
+            }
+
+            return best;
+        }
+
+    private:
+        typedef std::array<double, 4> Edge;
+
+        std::vector<Edge> edges;
+        std::vector<std::vector<std::size_t>> cells;
+        double xmin, ymin, cell_size;
+        long width, height;
+
+        [[nodiscard]] long to_col(double x) const {
+            return std::clamp((long) std::floor((x - xmin) / cell_size), 0L, width - 1);
+        }
+
+        [[nodiscard]] long to_row(double y) const {
+            return std::clamp((long) std::floor((y - ymin) / cell_size), 0L, height - 1);
+        }
+
+        static double squared_distance_to_edge(const Edge &edge, double x, double y) {
+            auto &[ax, ay, bx, by] = edge;
+            auto dx = bx - ax, dy = by - ay;
+            auto squared_length = dx * dx + dy * dy;
+            auto t = squared_length > 0 ? std::clamp(((x - ax) * dx + (y - ay) * dy) / squared_length, 0.0, 1.0)
+                                        : 0.0;
+            auto ex = ax + t * dx - x, ey = ay + t * dy - y;
+            return ex * ex + ey * ey;
+        }
+    };
+}
+
 namespace mowing {
 
     std::optional<WitnessSparsification::PointVector>
@@ -8,102 +100,102 @@ namespace mowing {
                                        [[maybe_unused]]const std::optional<ConicPolygon> &region,
                                        [[maybe_unused]]const std::optional<InputPolygon> &inputPolygon) {
 
-        if (witnesses.size() <= n) {
+        if (witnesses.size() <= n || witnesses.size() < 2) {
             return std::nullopt;
         }
 
-
-        std::vector<double> distances_to_boundary;
-
+        auto size = witnesses.size();
+        std::vector<double> xs, ys;
         for (auto &witness: witnesses) {
-            if (inputPolygon) {
-                // Factor in the distance to the boundary (if needed) so that points are preferred that are farther away
-                // from the boundary.
-                std::vector<double> distances;
-                for (auto it = inputPolygon->edges_begin(); it != inputPolygon->edges_end(); it++) {
-                    auto s = ::utils::minimum_distance(it->source(), it->target(), witness);
-                    distances.emplace_back(CGAL::to_double(s->squared_length()));
-                }
-                distances_to_boundary.emplace_back(*std::min_element(distances.begin(), distances.end()));
-            } else {
-                distances_to_boundary.emplace_back(0);
-            }
+            xs.emplace_back(CGAL::to_double(witness.x()));
+            ys.emplace_back(CGAL::to_double(witness.y()));
         }
 
-        using IndexPair = std::pair<std::size_t, std::size_t>;
-        std::map<IndexPair, double> distances;
+        // Factor in the distance to the boundary (if needed) so that points are preferred that are farther away
+        // from the boundary.
+        std::vector<double> distances_to_boundary(size, 0);
+        if (inputPolygon) {
+            auto boundary = BoundaryGrid(*inputPolygon);
+            for (std::size_t i = 0; i < size; i++) {
+                distances_to_boundary[i] = boundary.squared_distance(xs[i], ys[i]);
+            }
+        }
 
-        std::set<size_t> selected_indices;
-        std::vector<size_t> unselected_indices;
+        auto squared_distance = [&xs, &ys](std::size_t i, std::size_t j) {
+            return (xs[i] - xs[j]) * (xs[i] - xs[j]) + (ys[i] - ys[j]) * (ys[i] - ys[j]);
+        };
 
         double maxDistance = 0;
         double maxDistanceToBoundary = *std::max_element(distances_to_boundary.begin(), distances_to_boundary.end());
 
-        for (std::size_t i = 0; i < witnesses.size(); i++) {
-            unselected_indices.emplace_back(i);
-            for (std::size_t j = i + 1; j < witnesses.size(); j++) {
-                distances[std::make_pair(i, j)] = CGAL::to_double(CGAL::squared_distance(witnesses[i],
-                                                                                         witnesses[j]));
-                maxDistance = std::max(maxDistance, distances[std::make_pair(i, j)]);
+        for (std::size_t i = 0; i < size; i++) {
+            for (std::size_t j = i + 1; j < size; j++) {
+                maxDistance = std::max(maxDistance, squared_distance(i, j));
             }
         }
 
-        if (inputPolygon) {
-            // Add boundary distance to distance matrix with a factor.
-            for (std::size_t i = 0; i < witnesses.size(); i++) {
-                for (std::size_t j = i + 1; j < witnesses.size(); j++) {
-                    distances[std::make_pair(i, j)] = distances[std::make_pair(i, j)] / maxDistance +
-                                                      +0.5 * (distances_to_boundary[i] / maxDistanceToBoundary +
-                                                              distances_to_boundary[j] / maxDistanceToBoundary);
+        // The distances are computed when needed instead of storing all pairs.
+        auto distance = [&](std::size_t i, std::size_t j) {
+            if (!inputPolygon) return squared_distance(i, j);
+            // Add boundary distance to the distance with a factor.
+            return squared_distance(i, j) / maxDistance +
+                   +0.5 * (distances_to_boundary[i] / maxDistanceToBoundary +
+                           distances_to_boundary[j] / maxDistanceToBoundary);
+        };
+
+        // Do 2-Approximation of p-dispersion
+        std::size_t first = 0, second = 1;
+        double longestDistance = distance(0, 1);
+        for (std::size_t i = 0; i < size; i++) {
+            for (std::size_t j = i + 1; j < size; j++) {
+                auto d = distance(i, j);
+                if (d > longestDistance) {
+                    first = i;
+                    second = j;
+                    longestDistance = d;
                 }
             }
         }
-        // Do 2-Approximation of p-dispersion
-        auto longestDistancePair = std::max_element(distances.begin(), distances.end(),
-                                                    [](const std::pair<IndexPair, double> &p1,
-                                                       const std::pair<IndexPair, double> &p2) {
-                                                        return p1.second < p2.second;
-                                                    });
-
-        auto delete_from_unselected = [&unselected_indices](const std::size_t &idx) {
-            auto position = std::find(unselected_indices.begin(), unselected_indices.end(), idx);
-            if (position != unselected_indices.end())
-                unselected_indices.erase(position);
-        };
 
-        selected_indices.insert(longestDistancePair->first.first);
-        selected_indices.insert(longestDistancePair->first.second);
+        // The minimum distance of every point to the selected ones, which is updated with every selected point.
+        std::vector<double> min_distances(size, longestDistance);
+        std::vector<bool> selected(size, false);
+        std::size_t num_selected = 0;
 
-        delete_from_unselected(longestDistancePair->first.first);
-        delete_from_unselected(longestDistancePair->first.second);
+        auto select = [&](std::size_t idx) {
+            selected[idx] = true;
+            num_selected++;
+            for (std::size_t i = 0; i < size; i++) {
+                if (!selected[i]) min_distances[i] = std::min(min_distances[i], distance(i, idx));
+            }
+        };
 
+        select(first);
+        select(second);
 
-        while (selected_indices.size() < n) {
+        while (num_selected < n) {
             double overall_max_min_distance = 0;
-            auto index_to_add = unselected_indices.front();
+            std::optional<std::size_t> index_to_add;
 
-            for (auto &i: unselected_indices) {
-                double min_distance = longestDistancePair->second;
-                for (auto &j: selected_indices) {
-                    min_distance = std::min(min_distance, distances[std::make_pair(std::min(i, j), std::max(i, j))]);
-                }
+            for (std::size_t i = 0; i < size; i++) {
+                if (selected[i]) continue;
+                if (!index_to_add) index_to_add = i; // the first unselected point if all distances are 0
 
-                if (overall_max_min_distance < min_distance) {
+                if (overall_max_min_distance < min_distances[i]) {
                     index_to_add = i;
-                    overall_max_min_distance = min_distance;
+                    overall_max_min_distance = min_distances[i];
                 }
             }
 
-            selected_indices.insert(index_to_add);
-            delete_from_unselected(index_to_add);
+            select(*index_to_add);
         }
 
-        std::sort(unselected_indices.begin(), unselected_indices.end());  // Make sure the container is sorted
-        for (auto it = unselected_indices.rbegin(); it != unselected_indices.rend(); it++) {
-            witnesses.erase(witnesses.begin() + (long) *it);
+        auto selected_witnesses = PointVector();
+        for (std::size_t i = 0; i < size; i++) {
+            if (selected[i]) selected_witnesses.push_back(witnesses[i]);
         }
+        witnesses = std::move(selected_witnesses);
 
         return std::nullopt;
     }
 }
-
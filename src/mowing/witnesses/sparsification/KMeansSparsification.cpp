@@ -1,7 +1,16 @@
 #include "mowing/witnesses/sparsification/KMeansSparsification.h"
 
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/thread.hpp>
+
 namespace mowing {
 
+    KMeansSparsification::KMeansSparsification(unsigned max_threads) : max_threads(max_threads) {}
+
     std::optional<WitnessSparsification::PointVector>
     KMeansSparsification::sparsify(PointVector &witnesses, std::size_t n,
                                    [[maybe_unused]]const std::optional<ConicPolygon> &region,
@@ -18,92 +27,161 @@ namespace mowing {
             return centroids;
         }
 
-        std::vector<std::size_t> labels(witnesses.size(), 0);
-
-        RandomPlacementStrategy randomPlacementStrategy;
-        randomPlacementStrategy.placeWitnesses(centroids, n, *region);
-
-        assert(centroids.size() == n);
-
-        std::vector<Point> oldCentroids;
-        std::size_t currentIteration = 0;
-
-        auto shouldStop = [&currentIteration, &centroids, &oldCentroids]() {
-            bool stop = true;
-
-            if (currentIteration > 200) return true;
+        // The clustering works on doubles, the exact points are only used for the result.
+        const auto size = witnesses.size();
+        std::vector<double> xs(size), ys(size);
+        for (std::size_t i = 0; i < size; i++) {
+            xs[i] = CGAL::to_double(witnesses[i].x());
+            ys[i] = CGAL::to_double(witnesses[i].y());
+        }
 
-            for (std::size_t i = 0; i < centroids.size(); i++) {
-                if (centroids[i] != oldCentroids[i]) {
-                    stop = false;
-                    break;
-                }
+        std::vector<double> cxs, cys;
+        std::vector<std::size_t> labels(size, 0);
+        std::vector<double> distances(size); // squared distance of every point to its centroid
+        std::mt19937 re(std::random_device{}());
+
+        // k-means++ seeding: every centroid is a point drawn with a probability proportional to the squared
+        // distance to the closest centroid so far.
+        {
+            auto first = std::uniform_int_distribution<std::size_t>(0, size - 1)(re);
+            cxs.push_back(xs[first]);
+            cys.push_back(ys[first]);
+            for (std::size_t i = 0; i < size; i++) {
+                distances[i] = (xs[i] - cxs[0]) * (xs[i] - cxs[0]) + (ys[i] - cys[0]) * (ys[i] - cys[0]);
             }
 
-            return stop;
-        };
+            while (cxs.size() < n) {
+                auto total = std::accumulate(distances.begin(), distances.end(), 0.0);
+                std::size_t next;
+                if (total > 0) {
+                    next = std::discrete_distribution<std::size_t>(distances.begin(), distances.end())(re);
+                } else {
+                    next = std::uniform_int_distribution<std::size_t>(0, size - 1)(re); // only duplicates left
+                }
 
-        auto getPointsForCentroid = [&witnesses, &labels](std::size_t k) {
-            std::vector<Point> pointsForCentroid;
-            for (std::size_t i = 0; i < labels.size(); i++) {
-                if (labels[i] == k) {
-                    pointsForCentroid.emplace_back(witnesses[i]);
+                cxs.push_back(xs[next]);
+                cys.push_back(ys[next]);
+                for (std::size_t i = 0; i < size; i++) {
+                    auto d = (xs[i] - xs[next]) * (xs[i] - xs[next]) + (ys[i] - ys[next]) * (ys[i] - ys[next]);
+                    distances[i] = std::min(distances[i], d);
                 }
             }
-            return pointsForCentroid;
-        };
-
-        auto calculateLabels = [&centroids, &witnesses, &labels]() {
-            for (std::size_t i = 0; i < witnesses.size(); i++) {
-                auto minDistance = CGAL::squared_distance(witnesses[i], centroids[0]);
-                std::size_t label = 0;
+        }
 
-                for (std::size_t k = 1; k < centroids.size(); k++) {
-                    auto currentDistance = CGAL::squared_distance(witnesses[i], centroids[k]);
-                    if (currentDistance < minDistance) {
-                        minDistance = currentDistance;
-                        label = k;
-                    }
+        // Assigns the points [begin, end) to their closest centroid and returns whether a label changed.
+        auto calculateLabels = [&](std::size_t begin, std::size_t end) {
+            bool changed = false;
+            std::vector<double> centroidDistances(n);
+            for (std::size_t i = begin; i < end; i++) {
+                // Separate loop without branches, such that the compiler can vectorize it.
+                for (std::size_t k = 0; k < n; k++) {
+                    centroidDistances[k] = (cxs[k] - xs[i]) * (cxs[k] - xs[i]) + (cys[k] - ys[i]) * (cys[k] - ys[i]);
                 }
+                auto label = (std::size_t) (std::min_element(centroidDistances.begin(), centroidDistances.end()) -
+                                            centroidDistances.begin());
 
+                changed |= labels[i] != label;
                 labels[i] = label;
+                distances[i] = centroidDistances[label];
             }
+            return changed;
         };
 
-        auto generateRandomPoint = [&region]() {
-            std::vector<Point> centroidDummy; // Doing this to reuse the function
-            RandomPlacementStrategy randomPlacementStrategy;
-            randomPlacementStrategy.placeWitnesses(centroidDummy, 1, *region); // Adding 1 random centroids
-            return *centroidDummy.begin();
-        };
+        // Only large instances are worth the threads.
+        const std::size_t parallel_threshold = 1 << 16;
+        const auto max_threads = this->max_threads != 0 ? this->max_threads
+                                                        : std::max(1u, std::thread::hardware_concurrency());
+        const auto num_threads = size * n >= parallel_threshold ? max_threads : 1u;
+
+        std::vector<double> sumX(n), sumY(n);
+        std::vector<std::size_t> counts(n);
+
+        auto calculateCentroids = [&]() {
+            std::fill(sumX.begin(), sumX.end(), 0);
+            std::fill(sumY.begin(), sumY.end(), 0);
+            std::fill(counts.begin(), counts.end(), 0);
+            for (std::size_t i = 0; i < size; i++) {
+                sumX[labels[i]] += xs[i];
+                sumY[labels[i]] += ys[i];
+                counts[labels[i]]++;
+            }
 
-        auto calculateCentroids = [&centroids, &getPointsForCentroid, &generateRandomPoint]() {
-            for (std::size_t k = 0; k < centroids.size(); k++) {
-                std::vector<Point> pointsForCentroid = getPointsForCentroid(k);
-                if (pointsForCentroid.empty()) {
-                    centroids[k] = generateRandomPoint();
+            for (std::size_t k = 0; k < n; k++) {
+                if (counts[k] == 0) {
+                    // Move an empty centroid to the point farthest from its centroid.
+                    auto farthest = (std::size_t) (std::max_element(distances.begin(), distances.end()) -
+                                                   distances.begin());
+                    if (distances[farthest] == 0) continue; // only duplicates left
+
+                    cxs[k] = xs[farthest];
+                    cys[k] = ys[farthest];
+                    distances[farthest] = 0;
                 } else {
-                    centroids[k] = CGAL::centroid(pointsForCentroid.begin(), pointsForCentroid.end());
+                    cxs[k] = sumX[k] / (double) counts[k];
+                    cys[k] = sumY[k] / (double) counts[k];
+                }
+            }
+        };
+
+        // The threads are started once and assign their part of the points in every iteration. In between, the
+        // first thread updates the centroids while the others wait.
+        std::size_t currentIteration = 0;
+        bool done = false;
+        std::vector<char> changed(num_threads, false);
+        boost::barrier labelsCalculated(num_threads), centroidsCalculated(num_threads);
+
+        auto iterate = [&](unsigned thread) {
+            const auto begin = size * thread / num_threads, end = size * (thread + 1) / num_threads;
+            while (true) {
+                changed[thread] = calculateLabels(begin, end);
+                labelsCalculated.wait();
+                if (thread == 0) {
+                    // The labels of the initial centroids always need an update.
+                    auto anyChanged = currentIteration == 0 ||
+                                      std::find(changed.begin(), changed.end(), true) != changed.end();
+                    if (anyChanged && currentIteration <= 200) {
+                        calculateCentroids();
+                        currentIteration++;
+                    } else {
+                        done = true;
+                    }
                 }
+                centroidsCalculated.wait();
+                if (done) return;
             }
         };
 
-        do {
-            oldCentroids = std::vector<Point>(centroids);
-            calculateLabels();
-            calculateCentroids();
-            currentIteration++;
-        } while (!shouldStop());
+        boost::thread_group tg;
+        for (unsigned thread = 1; thread < num_threads; thread++) {
+            tg.create_thread([&iterate, thread]() { iterate(thread); });
+        }
+        iterate(0);
+        tg.join_all();
+
+        // Select a random point of every cluster in one pass (reservoir sampling).
+        std::vector<std::optional<std::size_t>> selected(n);
+        std::fill(counts.begin(), counts.end(), 0);
+        for (std::size_t i = 0; i < size; i++) {
+            auto k = labels[i];
+            if (std::uniform_int_distribution<std::size_t>(0, counts[k]++)(re) == 0) {
+                selected[k] = i;
+            }
+        }
 
         std::vector<Point> newWitnessSet;
-        std::default_random_engine re(std::random_device{}());
-        for (std::size_t k = 0; k < centroids.size(); k++) {
-            std::vector<Point> pointsForCentroid = getPointsForCentroid(k);
-            if (pointsForCentroid.empty()) {
-                newWitnessSet.emplace_back(generateRandomPoint());
+        for (std::size_t k = 0; k < n; k++) {
+            centroids.emplace_back(cxs[k], cys[k]);
+
+            if (selected[k]) {
+                newWitnessSet.emplace_back(witnesses[*selected[k]]);
+            } else if (region) {
+                // An empty cluster is only possible if there are fewer distinct points than clusters.
+                std::vector<Point> centroidDummy; // Doing this to reuse the function
+                RandomPlacementStrategy randomPlacementStrategy;
+                randomPlacementStrategy.placeWitnesses(centroidDummy, 1, *region);
+                newWitnessSet.emplace_back(*centroidDummy.begin());
             } else {
-                newWitnessSet.emplace_back(
-                        *::utils::select_randomly(pointsForCentroid.begin(), pointsForCentroid.end(), re));
+                newWitnessSet.emplace_back(witnesses[std::uniform_int_distribution<std::size_t>(0, size - 1)(re)]);
             }
         }
 
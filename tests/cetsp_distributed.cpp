@@ -0,0 +1,186 @@
+#define BOOST_TEST_MODULE cetsp_distributed
+
+#include <boost/test/included/unit_test.hpp>
+#include <chrono>
+#include <future>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "cetsp/distributed.h"
+#include "cetsp/strategies/root_node_strategy.h"
+
+using namespace boost::unit_test;
+
+/**
+ * A worker speaking the protocol by hand, such that it can be killed at a
+ * defined point.
+ */
+class ScriptedWorker {
+public:
+    explicit ScriptedWorker(const std::string &address)
+            : connection(cetsp::details::connect_to(address)) {
+        auto header = connection.receive(10000);
+        BOOST_REQUIRE(header && header->rfind("INSTANCE", 0) == 0);
+    }
+
+    /**
+     * Waits for the next message that is not an incumbent.
+     */
+    std::optional<std::string> receive(int timeout_ms) {
+        while (auto line = connection.receive(timeout_ms)) {
+            if (line->rfind("UB", 0) != 0) {
+                return line;
+            }
+        }
+        return std::nullopt;
+    }
+
+    cetsp::details::LineConnection connection;
+};
+
+BOOST_AUTO_TEST_CASE(requeue_to_idle_worker)
+{
+    const auto address = "unix:/tmp/cetsp_test_distributed_" + std::to_string(::getpid()) + ".sock";
+    cetsp::Instance instance({{cetsp::Point(0, 0), 1},
+                              {cetsp::Point(10, 0), 1},
+                              {cetsp::Point(10, 10), 1},
+                              {cetsp::Point(0, 10), 1},
+                              {cetsp::Point(5, 5), 1}});
+    cetsp::ConvexHullRoot root_strategy;
+    cetsp::FarthestCircle branching_strategy(false, 1);
+    cetsp::DistributedCoordinator coordinator(&instance, root_strategy.get_root_node(instance),
+                                              branching_strategy, address);
+    // A frontier of one subproblem: the root.
+    auto coordinator_thread = std::thread([&coordinator]() { coordinator.optimize(30, 0.01, 1, false); });
+
+    std::string subproblem;
+    {
+        ScriptedWorker killed(address);
+        killed.connection.send("READY");
+        auto line = killed.receive(10000);
+        BOOST_REQUIRE(line && line->rfind("SUB", 0) == 0);
+        subproblem = *line;
+
+        // The second worker asks while nothing is pending.
+        ScriptedWorker idle(address);
+        idle.connection.send("READY");
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        BOOST_TEST(!idle.receive(0));
+
+        // Kill the first worker. Its subproblem has to go to the idle one.
+        killed.connection.close();
+        line = idle.receive(10000);
+        BOOST_REQUIRE(line);
+        std::istringstream sub(subproblem), requeued(*line);
+        std::string type, id, requeued_id;
+        sub >> type >> id;
+        requeued >> type >> requeued_id;
+        BOOST_TEST(type == "SUB");
+        std::string rest, requeued_rest;
+        std::getline(sub, rest);
+        std::getline(requeued, requeued_rest);
+        BOOST_TEST(rest == requeued_rest); // same bound and sequence
+
+        idle.connection.send("DONE " + requeued_id + " 1e100");
+        line = idle.receive(10000);
+        BOOST_TEST((line && *line == "STOP"));
+    }
+    coordinator_thread.join();
+    BOOST_TEST(coordinator.get_statistics()["num_subproblems_solved"] == "1");
+}
+
+BOOST_AUTO_TEST_CASE(drop_worker_on_unknown_message)
+{
+    const auto address = "unix:/tmp/cetsp_test_distributed_" + std::to_string(::getpid()) + "_2.sock";
+    cetsp::Instance instance({{cetsp::Point(0, 0), 1},
+                              {cetsp::Point(10, 0), 1},
+                              {cetsp::Point(10, 10), 1},
+                              {cetsp::Point(0, 10), 1}});
+    cetsp::ConvexHullRoot root_strategy;
+    cetsp::FarthestCircle branching_strategy(false, 1);
+    cetsp::DistributedCoordinator coordinator(&instance, root_strategy.get_root_node(instance),
+                                              branching_strategy, address);
+    auto coordinator_thread = std::thread([&coordinator]() { coordinator.optimize(30, 0.01, 1, false); });
+
+    {
+        ScriptedWorker broken(address);
+        broken.connection.send("READY");
+        BOOST_REQUIRE(broken.receive(10000));
+        broken.connection.send("GARBAGE");
+        // The coordinator closes the connection instead of throwing.
+        BOOST_TEST(!broken.receive(10000));
+        BOOST_TEST(broken.connection.is_closed());
+
+        ScriptedWorker worker(address);
+        worker.connection.send("READY");
+        auto line = worker.receive(10000);
+        BOOST_REQUIRE((line && line->rfind("SUB", 0) == 0));
+        std::istringstream sub(*line);
+        std::string type, id;
+        sub >> type >> id;
+        worker.connection.send("DONE " + id + " 1e100");
+        line = worker.receive(10000);
+        BOOST_TEST((line && *line == "STOP"));
+    }
+    coordinator_thread.join();
+}
+
+BOOST_AUTO_TEST_CASE(forked_workers_find_optimum)
+{
+    const auto address = "unix:/tmp/cetsp_test_distributed_" + std::to_string(::getpid()) + "_3.sock";
+    std::mt19937 re(4);
+    std::uniform_real_distribution<double> coordinate(0, 100);
+    std::vector<cetsp::Circle> circles;
+    // Large enough that the frontier does not already solve the instance.
+    for (int i = 0; i < 20; i++) {
+        circles.emplace_back(cetsp::Point(coordinate(re), coordinate(re)), 3);
+    }
+    cetsp::Instance instance(circles);
+
+    // The workers are separate processes that only share the socket with the coordinator.
+    std::vector<pid_t> workers;
+    for (int i = 0; i < 2; i++) {
+        const auto pid = ::fork();
+        BOOST_REQUIRE(pid >= 0);
+        if (pid == 0) {
+            int status = 0;
+            try {
+                cetsp::DistributedWorker worker(address, []() {
+                    return std::make_pair(std::unique_ptr<cetsp::BranchingStrategy>(
+                                                  std::make_unique<cetsp::FarthestCircle>(false, 1)),
+                                          std::unique_ptr<cetsp::SearchStrategy>(std::make_unique<cetsp::DfsBfs>()));
+                });
+                worker.run(60, 0.01, false);
+            } catch (std::exception &) {
+                status = 1;
+            }
+            ::_exit(status);
+        }
+        workers.push_back(pid);
+    }
+
+    cetsp::ConvexHullRoot root_strategy;
+    cetsp::FarthestCircle branching_strategy(false, 1);
+    cetsp::DistributedCoordinator coordinator(&instance, root_strategy.get_root_node(instance),
+                                              branching_strategy, address);
+    coordinator.optimize(60, 0.01, 16, false);
+    for (auto pid: workers) {
+        int status = 0;
+        BOOST_REQUIRE(::waitpid(pid, &status, 0) == pid);
+        BOOST_TEST((WIFEXITED(status) && WEXITSTATUS(status) == 0));
+    }
+    BOOST_TEST(std::stoi(coordinator.get_statistics()["num_subproblems_solved"]) > 0);
+
+    cetsp::FarthestCircle local_branching(false, 1);
+    cetsp::DfsBfs local_search;
+    cetsp::BranchAndBoundAlgorithm bnb(&instance, root_strategy.get_root_node(instance), local_branching,
+                                       local_search);
+    bnb.optimize(60, 0.01, false);
+
+    BOOST_REQUIRE(coordinator.get_solution() != nullptr);
+    BOOST_TEST(coordinator.get_upper_bound() <= 1.01 * coordinator.get_lower_bound());
+    BOOST_TEST(coordinator.get_upper_bound() <= 1.01 * bnb.get_lower_bound());
+    BOOST_TEST(bnb.get_upper_bound() <= 1.01 * coordinator.get_lower_bound());
+}
@@ -0,0 +1,65 @@
+#define BOOST_TEST_MODULE cetsp_diving_heuristic
+
+#include <boost/test/included/unit_test.hpp>
+#include <random>
+#include "cetsp/bnb.h"
+#include "cetsp/diving_heuristic.h"
+#include "cetsp/strategies/root_node_strategy.h"
+
+using namespace boost::unit_test;
+
+cetsp::Instance random_instance(int n, unsigned seed) {
+    std::mt19937 re(seed);
+    std::uniform_real_distribution<double> coordinate(0, 100);
+    std::vector<cetsp::Circle> circles;
+    for (int i = 0; i < n; i++) {
+        circles.emplace_back(cetsp::Point(coordinate(re), coordinate(re)), 3);
+    }
+    return cetsp::Instance(circles);
+}
+
+BOOST_AUTO_TEST_CASE(dive_to_feasible_tour)
+{
+    auto instance = random_instance(20, 0);
+    std::atomic<bool> abort{false};
+    auto solution = cetsp::DivingHeuristicCallback::dive(instance, {}, abort);
+    BOOST_REQUIRE(solution);
+    BOOST_TEST(solution->is_feasible());
+
+    abort = true;
+    BOOST_TEST(!cetsp::DivingHeuristicCallback::dive(instance, {}, abort));
+}
+
+BOOST_AUTO_TEST_CASE(dives_during_breadth_first_search)
+{
+    auto instance = random_instance(15, 1);
+    cetsp::ConvexHullRoot root_strategy;
+    cetsp::FarthestCircle branching(false, 1);
+    cetsp::CheapestBreadthFirst search;
+    cetsp::BranchAndBoundAlgorithm bnb(&instance, root_strategy.get_root_node(instance), branching, search);
+    auto callback = std::make_unique<cetsp::DivingHeuristicCallback>(10, 5);
+    auto *diving = callback.get();
+    bnb.add_node_callback(std::move(callback));
+
+    bnb.optimize(60, 0.01, false);
+    BOOST_TEST(diving->get_num_dives() >= 1);
+    BOOST_TEST(!diving->is_diving());
+    BOOST_TEST(bnb.get_upper_bound() <= 1.01 * bnb.get_lower_bound());
+}
+
+BOOST_AUTO_TEST_CASE(stop_dive_on_termination)
+{
+    auto instance = random_instance(30, 2);
+    cetsp::ConvexHullRoot root_strategy;
+    cetsp::FarthestCircle branching(false, 1);
+    cetsp::CheapestBreadthFirst search;
+    cetsp::BranchAndBoundAlgorithm bnb(&instance, root_strategy.get_root_node(instance), branching, search);
+    auto callback = std::make_unique<cetsp::DivingHeuristicCallback>(1, 1);
+    auto *diving = callback.get();
+    bnb.add_node_callback(std::move(callback));
+
+    // Times out after the root, at which a dive has been started.
+    bnb.optimize(0, 0.01, false);
+    BOOST_TEST(diving->get_num_dives() == 1);
+    BOOST_TEST(!diving->is_diving());
+}
@@ -0,0 +1,67 @@
+#define BOOST_TEST_MODULE cetsp_hilbert_order
+
+#include <boost/test/included/unit_test.hpp>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include "cetsp/solver.h"
+
+using namespace boost::unit_test;
+
+/**
+ * Rotates the tour to start at the smallest index and chooses the direction in which the second index is smaller,
+ * such that the same tour always gives the same sequence.
+ */
+std::vector<int> normalize_tour(std::vector<int> sequence) {
+    std::rotate(sequence.begin(), std::min_element(sequence.begin(), sequence.end()), sequence.end());
+    if (sequence.size() > 2 && sequence.back() < sequence[1]) {
+        std::reverse(sequence.begin() + 1, sequence.end());
+    }
+    return sequence;
+}
+
+BOOST_AUTO_TEST_CASE(reordering_keeps_original_indices)
+{
+    std::mt19937 re(0);
+    std::uniform_real_distribution<double> coordinate(0, 100);
+    cetsp::Instance instance;
+    for (int i = 0; i < 50; i++) {
+        auto circle = cetsp::Circle(cetsp::Point(coordinate(re), coordinate(re)), 0.1);
+        instance.add_circle(circle);
+    }
+    const std::vector<cetsp::Circle> circles(instance.begin(), instance.end());
+    const auto revision = instance.revision;
+    instance.reorder_along_hilbert_curve();
+    BOOST_TEST(instance.revision > revision);
+    BOOST_TEST(instance.size() == circles.size());
+    for (int i = 0; i < static_cast<int>(instance.size()); i++) {
+        BOOST_TEST((instance[i].center == circles[instance.original_index(i)].center));
+    }
+    // Circles added afterwards keep their index of insertion.
+    auto circle = cetsp::Circle(cetsp::Point(200, 200), 0.1);
+    instance.add_circle(circle);
+    BOOST_TEST(instance.original_index(static_cast<int>(instance.size()) - 1) == 50);
+}
+
+BOOST_AUTO_TEST_CASE(same_solution_with_and_without_reordering)
+{
+    // Points in convex position have a unique optimal tour along the hull. They are given in a shuffled order,
+    // such that the sequence has to be translated back to match.
+    std::vector<int> order(12);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(1));
+    std::vector<CGALPoint> points;
+    for (const auto k : order) {
+        const auto angle = 2 * M_PI * k / order.size();
+        points.emplace_back(50 + 40 * std::cos(angle), 50 + 40 * std::sin(angle));
+    }
+    const std::shared_ptr<CGALPoint> no_start;
+    auto solution = cetsp::solve(points, no_start, 1.0, 60, false, 1, false);
+    auto reordered_solution = cetsp::solve(points, no_start, 1.0, 60, false, 1, true);
+    BOOST_TEST(solution.optimal_solution_found);
+    BOOST_TEST(reordered_solution.optimal_solution_found);
+    BOOST_TEST(std::abs(solution.upper_bound - reordered_solution.upper_bound) <= 1e-3 * solution.upper_bound);
+    BOOST_TEST(solution.sequence.size() == points.size());
+    BOOST_TEST(normalize_tour(solution.sequence) == normalize_tour(reordered_solution.sequence));
+}
@@ -0,0 +1,87 @@
+#define BOOST_TEST_MODULE cetsp_intersection_branching
+
+#include <boost/test/included/unit_test.hpp>
+#include <algorithm>
+#include <random>
+#include "cetsp/bnb.h"
+#include "cetsp/strategies/root_node_strategy.h"
+
+using namespace boost::unit_test;
+
+cetsp::Instance random_instance(int n, unsigned seed) {
+    std::mt19937 re(seed);
+    std::uniform_real_distribution<double> coordinate(0, 100);
+    std::vector<cetsp::Circle> circles;
+    for (int i = 0; i < n; i++) {
+        circles.emplace_back(cetsp::Point(coordinate(re), coordinate(re)), 3);
+    }
+    return cetsp::Instance(circles);
+}
+
+/**
+ * Counts the branched nodes whose relaxed trajectory crosses itself.
+ */
+class CountingIntersectionBranching : public cetsp::IntersectionBranching {
+public:
+    bool branch(cetsp::Node &node) override {
+        if (!node.get_intersections().empty()) {
+            this->num_crossing_nodes += 1;
+        }
+        return cetsp::IntersectionBranching::branch(node);
+    }
+
+    long num_crossing_nodes = 0;
+};
+
+struct Result {
+    double upper_bound;
+    double lower_bound;
+};
+
+Result run(cetsp::Instance &instance, cetsp::BranchingStrategy &branching) {
+    cetsp::ConvexHullRoot root_strategy;
+    cetsp::DfsBfs search;
+    cetsp::BranchAndBoundAlgorithm bnb(&instance, root_strategy.get_root_node(instance), branching, search);
+    bnb.optimize(60, 0.01, false);
+    return {bnb.get_upper_bound(), bnb.get_lower_bound()};
+}
+
+BOOST_AUTO_TEST_CASE(uncrossed_child)
+{
+    // The sequence 0, 2, 1, 3 crosses itself in the square. Distinct radii
+    // keep the order of the circles in the instance.
+    cetsp::Instance instance({cetsp::Circle(cetsp::Point(0, 0), 1.0), cetsp::Circle(cetsp::Point(10, 0), 1.1),
+                              cetsp::Circle(cetsp::Point(10, 10), 1.2), cetsp::Circle(cetsp::Point(0, 10), 1.3),
+                              cetsp::Circle(cetsp::Point(5, 30), 1.4)});
+    auto root = std::make_shared<cetsp::Node>(std::vector<int>{0, 2, 1, 3}, &instance);
+    cetsp::SolutionPool solution_pool;
+    cetsp::IntersectionBranching branching(false, 1);
+    branching.setup(&instance, root, &solution_pool);
+    BOOST_TEST(!root->get_intersections().empty());
+    BOOST_TEST(branching.branch(*root));
+    // The four insertions of the missing circle and the 2-opt move.
+    const auto &children = root->get_children();
+    BOOST_TEST(children.size() == 5);
+    const std::vector<int> uncrossed{0, 1, 2, 3};
+    BOOST_TEST(std::any_of(children.begin(), children.end(),
+                           [&uncrossed](const auto &child) { return child->get_fixed_sequence() == uncrossed; }));
+}
+
+BOOST_AUTO_TEST_CASE(same_optimum_as_farthest_circle)
+{
+    long num_crossing_nodes = 0;
+    for (unsigned seed = 1; seed <= 5; seed++) {
+        auto instance = random_instance(15, seed);
+        cetsp::FarthestCircle farthest(false, 1);
+        CountingIntersectionBranching intersection;
+        auto farthest_result = run(instance, farthest);
+        auto intersection_result = run(instance, intersection);
+        // Both solve the instance to the gap.
+        BOOST_TEST(intersection_result.upper_bound <= 1.01 * farthest_result.lower_bound);
+        BOOST_TEST(farthest_result.upper_bound <= 1.01 * intersection_result.lower_bound);
+        num_crossing_nodes += intersection.num_crossing_nodes;
+    }
+    BOOST_TEST_MESSAGE("Branched nodes with crossings: " << num_crossing_nodes);
+    // Otherwise, the reordering has not been tested.
+    BOOST_TEST(num_crossing_nodes > 0);
+}
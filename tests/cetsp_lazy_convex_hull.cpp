@@ -0,0 +1,93 @@
+#define BOOST_TEST_MODULE cetsp_lazy_convex_hull
+
+#include <boost/test/included/unit_test.hpp>
+#include <random>
+#include "cetsp/bnb.h"
+#include "cetsp/strategies/root_node_strategy.h"
+#include "cetsp/strategies/rules/global_convex_hull_rule.h"
+#include "cetsp/strategies/rules/layered_convex_hull_rule.h"
+
+using namespace boost::unit_test;
+
+std::vector<cetsp::Circle> random_circles(int n, unsigned seed) {
+    std::mt19937 re(seed);
+    std::uniform_real_distribution<double> coordinate(0, 100);
+    std::vector<cetsp::Circle> circles;
+    for (int i = 0; i < n; i++) {
+        circles.emplace_back(cetsp::Point(coordinate(re), coordinate(re)), 3);
+    }
+    return circles;
+}
+
+/**
+ * Adds a circle at the first feasible node. No solution is known at this
+ * point, so it does not have to be covered by any solution.
+ */
+class AddCircleCallback : public cetsp::B2BNodeCallback {
+public:
+    explicit AddCircleCallback(cetsp::Circle circle) : circle{circle} {}
+
+    void add_lazy_constraints(cetsp::EventContext &context) override {
+        if (!added) {
+            added = true;
+            context.add_lazy_circle(circle);
+        }
+    }
+
+private:
+    cetsp::Circle circle;
+    bool added = false;
+};
+
+double solve_with_lazy_circle(cetsp::Circle lazy_circle, unsigned seed, int &num_restarts) {
+    cetsp::Instance instance(random_circles(10, seed));
+    cetsp::ConvexHullRoot root_strategy;
+    cetsp::ChFarthestCircle branching(false, 1);
+    branching.add_rule(std::make_unique<cetsp::GlobalConvexHullRule>());
+    branching.add_rule(std::make_unique<cetsp::LayeredConvexHullRule>());
+    cetsp::CheapestChildDepthFirst search;
+    cetsp::BranchAndBoundAlgorithm bnb(&instance, root_strategy.get_root_node(instance), branching, search);
+    bnb.add_node_callback(std::make_unique<AddCircleCallback>(lazy_circle));
+    bnb.optimize(60, 0.01, false);
+    BOOST_TEST(instance.size() == 11);
+    BOOST_TEST(bnb.get_upper_bound() <= 1.01 * bnb.get_lower_bound());
+    num_restarts = std::stoi(bnb.get_statistics()["num_restarts"]);
+    return bnb.get_upper_bound();
+}
+
+double solve_directly(cetsp::Circle circle, unsigned seed) {
+    auto circles = random_circles(10, seed);
+    circles.push_back(circle);
+    cetsp::Instance instance(circles);
+    cetsp::ConvexHullRoot root_strategy;
+    cetsp::FarthestCircle branching(false, 1);
+    cetsp::CheapestChildDepthFirst search;
+    cetsp::BranchAndBoundAlgorithm bnb(&instance, root_strategy.get_root_node(instance), branching, search);
+    bnb.optimize(60, 0.01, false);
+    return bnb.get_upper_bound();
+}
+
+BOOST_AUTO_TEST_CASE(circle_inside_hull)
+{
+    // Keeps the hulls, so the tree is kept as well.
+    const cetsp::Circle circle(cetsp::Point(50, 50), 0.5);
+    int num_restarts = 0;
+    auto lazy = solve_with_lazy_circle(circle, 0, num_restarts);
+    auto direct = solve_directly(circle, 0);
+    BOOST_TEST(num_restarts == 0);
+    BOOST_TEST(lazy <= 1.01 * direct);
+    BOOST_TEST(direct <= 1.01 * lazy);
+}
+
+BOOST_AUTO_TEST_CASE(circle_extending_hull)
+{
+    for (unsigned seed = 0; seed < 3; seed++) {
+        const cetsp::Circle circle(cetsp::Point(150, 50), 3);
+        int num_restarts = 0;
+        auto lazy = solve_with_lazy_circle(circle, seed, num_restarts);
+        auto direct = solve_directly(circle, seed);
+        BOOST_TEST(num_restarts == 1);
+        BOOST_TEST(lazy <= 1.01 * direct);
+        BOOST_TEST(direct <= 1.01 * lazy);
+    }
+}
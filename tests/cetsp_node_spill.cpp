@@ -0,0 +1,142 @@
+#define BOOST_TEST_MODULE cetsp_node_spill
+
+#include <boost/test/included/unit_test.hpp>
+#include <random>
+#include "cetsp/bnb.h"
+#include "cetsp/details/node_spill.h"
+#include "cetsp/heuristics.h"
+#include "cetsp/strategies/root_node_strategy.h"
+
+using namespace boost::unit_test;
+
+cetsp::Instance random_instance(int n, unsigned seed) {
+    std::mt19937 re(seed);
+    std::uniform_real_distribution<double> coordinate(0, 100);
+    std::vector<cetsp::Circle> circles;
+    for (int i = 0; i < n; i++) {
+        circles.emplace_back(cetsp::Point(coordinate(re), coordinate(re)), 3);
+    }
+    return cetsp::Instance(circles);
+}
+
+BOOST_AUTO_TEST_CASE(spill_and_reload_nodes)
+{
+    auto instance = random_instance(6, 0);
+    auto root = std::make_shared<cetsp::Node>(std::vector<int>{0, 1, 2}, &instance);
+    std::vector<std::shared_ptr<cetsp::Node>> children = {
+            std::make_shared<cetsp::Node>(std::vector<int>{0, 3, 1, 2}, &instance, root.get()),
+            std::make_shared<cetsp::Node>(std::vector<int>{0, 1, 3, 2}, &instance, root.get()),
+            std::make_shared<cetsp::Node>(std::vector<int>{0, 1, 2, 3}, &instance, root.get())};
+    root->branch(children);
+    const auto root_bound = root->get_lower_bound();
+
+    cetsp::details::NodeSpill spill(cetsp::details::NodeSpill::temporary_path());
+    BOOST_TEST(!spill.spill(*root)); // the root has no parent to reattach to
+    auto min_bound = std::numeric_limits<double>::infinity();
+    for (auto &child: children) {
+        min_bound = std::min(min_bound, child->get_lower_bound());
+        BOOST_TEST(spill.spill(*child));
+    }
+    BOOST_TEST(spill.size() == 3);
+    BOOST_TEST(root->get_children().empty());
+    BOOST_TEST(root->get_lower_bound() == root_bound); // the detached bounds are kept
+    BOOST_TEST(spill.get_lower_bound() == min_bound);
+
+    // The nodes come back in best-bound order with the same sequence and bound.
+    auto previous_bound = 0.0;
+    for (int i = 0; i < 3; i++) {
+        auto node = spill.reload();
+        BOOST_REQUIRE(node != nullptr);
+        BOOST_TEST(node->get_parent() == root.get());
+        BOOST_TEST(node->get_lower_bound() >= previous_bound);
+        previous_bound = node->get_lower_bound();
+        auto original = std::find_if(children.begin(), children.end(), [&node](auto &child) {
+            return child->get_fixed_sequence() == node->get_fixed_sequence();
+        });
+        BOOST_REQUIRE(original != children.end());
+        BOOST_TEST(node->get_lower_bound() == (*original)->get_lower_bound());
+    }
+    BOOST_TEST(spill.empty());
+    BOOST_TEST(spill.reload() == nullptr);
+    BOOST_TEST(root->get_children().size() == 3);
+}
+
+BOOST_AUTO_TEST_CASE(drop_nodes_of_pruned_parent)
+{
+    auto instance = random_instance(6, 1);
+    auto root = std::make_shared<cetsp::Node>(std::vector<int>{0, 1, 2}, &instance);
+    std::vector<std::shared_ptr<cetsp::Node>> children = {
+            std::make_shared<cetsp::Node>(std::vector<int>{0, 3, 1, 2}, &instance, root.get()),
+            std::make_shared<cetsp::Node>(std::vector<int>{0, 1, 3, 2}, &instance, root.get())};
+    root->branch(children);
+
+    cetsp::details::NodeSpill spill(cetsp::details::NodeSpill::temporary_path());
+    for (auto &child: children) {
+        BOOST_TEST(spill.spill(*child));
+    }
+    root->prune(false);
+    BOOST_TEST(spill.reload() == nullptr);
+    BOOST_TEST(spill.empty());
+    BOOST_TEST(root->get_children().empty());
+}
+
+BOOST_AUTO_TEST_CASE(search_with_spilling)
+{
+    // With a tiny memory budget, nearly every open node goes through the spill file.
+    auto instance = random_instance(12, 2);
+    cetsp::ConvexHullRoot root_strategy;
+
+    cetsp::FarthestCircle branching(false, 1);
+    cetsp::DfsBfs search;
+    cetsp::BranchAndBoundAlgorithm bnb(&instance, root_strategy.get_root_node(instance), branching, search);
+    bnb.optimize(60, 0.01, false);
+
+    cetsp::FarthestCircle spilling_branching(false, 1);
+    cetsp::DfsBfs spilling_search;
+    spilling_search.enable_spilling(cetsp::details::NodeSpill::temporary_path(), 1);
+    cetsp::BranchAndBoundAlgorithm spilling_bnb(&instance, root_strategy.get_root_node(instance),
+                                                spilling_branching, spilling_search);
+    spilling_bnb.optimize(60, 0.01, false);
+
+    BOOST_TEST(spilling_bnb.get_upper_bound() <= 1.01 * spilling_bnb.get_lower_bound());
+    BOOST_TEST(spilling_bnb.get_upper_bound() <= 1.01 * bnb.get_lower_bound());
+    BOOST_TEST(bnb.get_upper_bound() <= 1.01 * spilling_bnb.get_lower_bound());
+}
+
+BOOST_AUTO_TEST_CASE(no_spilling_after_lazily_added_circles)
+{
+    // The memory estimate of a node grows with the instance. Popping must not subtract more than was added, or
+    // the counter underflows and all nodes are spilled despite a large budget.
+    auto instance = random_instance(6, 3);
+    auto root = std::make_shared<cetsp::Node>(std::vector<int>{0, 1, 2}, &instance);
+    cetsp::DfsBfs search;
+    search.enable_spilling(cetsp::details::NodeSpill::temporary_path(), 1 << 30);
+    search.init(root);
+    BOOST_TEST(search.next() == root);
+
+    std::vector<std::shared_ptr<cetsp::Node>> children = {
+            std::make_shared<cetsp::Node>(std::vector<int>{0, 3, 1, 2}, &instance, root.get()),
+            std::make_shared<cetsp::Node>(std::vector<int>{0, 1, 3, 2}, &instance, root.get())};
+    root->branch(children);
+    search.notify_of_branch(*root);
+
+    for (int i = 0; i < 100; i++) {
+        cetsp::Circle circle(cetsp::Point(50, 50), 3);
+        instance.add_circle(circle);
+    }
+    auto node = search.next();
+    BOOST_REQUIRE(node != nullptr);
+
+    std::vector<std::shared_ptr<cetsp::Node>> grandchildren = {
+            std::make_shared<cetsp::Node>(std::vector<int>{0, 4, 3, 1, 2}, &instance, node.get()),
+            std::make_shared<cetsp::Node>(std::vector<int>{0, 3, 4, 1, 2}, &instance, node.get())};
+    node->branch(grandchildren);
+    search.notify_of_branch(*node);
+
+    // Nothing has been spilled, so the resident nodes come back as the same objects.
+    auto resident = std::vector<cetsp::Node *>{children[0].get(), children[1].get(), grandchildren[0].get(),
+                                               grandchildren[1].get()};
+    while (auto next = search.next()) {
+        BOOST_TEST((std::find(resident.begin(), resident.end(), next.get()) != resident.end()));
+    }
+}
@@ -0,0 +1,64 @@
+#define BOOST_TEST_MODULE cetsp_strong_branching
+
+#include <boost/test/included/unit_test.hpp>
+#include <random>
+#include "cetsp/bnb.h"
+#include "cetsp/strategies/root_node_strategy.h"
+
+using namespace boost::unit_test;
+
+cetsp::Instance random_instance(int n, unsigned seed) {
+    std::mt19937 re(seed);
+    std::uniform_real_distribution<double> coordinate(0, 100);
+    std::vector<cetsp::Circle> circles;
+    for (int i = 0; i < n; i++) {
+        circles.emplace_back(cetsp::Point(coordinate(re), coordinate(re)), 3);
+    }
+    return cetsp::Instance(circles);
+}
+
+struct Result {
+    double upper_bound;
+    double lower_bound;
+    long num_explored;
+};
+
+Result run(cetsp::Instance &instance, cetsp::BranchingStrategy &branching) {
+    cetsp::ConvexHullRoot root_strategy;
+    cetsp::DfsBfs search;
+    cetsp::BranchAndBoundAlgorithm bnb(&instance, root_strategy.get_root_node(instance), branching, search);
+    bnb.optimize(60, 0.01, false);
+    return {bnb.get_upper_bound(), bnb.get_lower_bound(), std::stol(bnb.get_statistics()["num_explored"])};
+}
+
+BOOST_AUTO_TEST_CASE(no_probes_below_depth_limit)
+{
+    // Without probing depths, it is exactly the branching on the farthest circle.
+    auto instance = random_instance(12, 0);
+    cetsp::FarthestCircle farthest(false, 1);
+    cetsp::StrongBranchingFarthestCircle strong(3, false, 1, 0);
+    auto farthest_result = run(instance, farthest);
+    auto strong_result = run(instance, strong);
+    BOOST_TEST(strong_result.num_explored == farthest_result.num_explored);
+    BOOST_TEST(strong_result.upper_bound == farthest_result.upper_bound);
+}
+
+BOOST_AUTO_TEST_CASE(fewer_nodes_than_farthest_circle)
+{
+    long farthest_nodes = 0, strong_nodes = 0;
+    for (unsigned seed = 1; seed <= 5; seed++) {
+        auto instance = random_instance(15, seed);
+        cetsp::FarthestCircle farthest(false, 1);
+        cetsp::StrongBranchingFarthestCircle strong(3, false, 1, 3);
+        auto farthest_result = run(instance, farthest);
+        auto strong_result = run(instance, strong);
+        // Both solve the instance to the gap.
+        BOOST_TEST(strong_result.upper_bound <= 1.01 * farthest_result.lower_bound);
+        BOOST_TEST(farthest_result.upper_bound <= 1.01 * strong_result.lower_bound);
+        farthest_nodes += farthest_result.num_explored;
+        strong_nodes += strong_result.num_explored;
+    }
+    BOOST_TEST_MESSAGE("Explored nodes: farthest circle " << farthest_nodes << ", strong branching "
+                                                          << strong_nodes);
+    BOOST_TEST(strong_nodes <= farthest_nodes);
+}
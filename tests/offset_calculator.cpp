@@ -0,0 +1,191 @@
+#define BOOST_TEST_MODULE offset_calculator
+
+#include <boost/test/included/unit_test.hpp>
+#include <fstream>
+#include <sstream>
+#include "mowing/ExactOffsetCalculator.h"
+#include "mowing/MowingSolverWithUpperBound.h"
+#include "mowing/utils/conversion.h"
+
+using namespace boost::unit_test;
+
+typedef mowing::ExactOffsetCalculator::Input_Linear_polygon Input_Linear_polygon;
+typedef mowing::ExactOffsetCalculator::Input_Point Input_Point;
+
+Input_Linear_polygon polygon_from_cgal_string(const std::string &s) {
+    Input_Linear_polygon polygon;
+    std::stringstream ss;
+    ss << s;
+    ss >> polygon;
+    return polygon;
+}
+
+Input_Linear_polygon read_instance(const std::string &name) {
+    std::ifstream input_file(std::string(INSTANCE_DIR) + "/" + name);
+    BOOST_REQUIRE(input_file.is_open());
+    std::string line;
+    std::getline(input_file, line);
+    return polygon_from_cgal_string(line);
+}
+
+/**
+ * The area of the uncovered regions, with the arcs approximated by polylines.
+ */
+double uncovered_area(mowing::ExactOffsetCalculator &calculator) {
+    auto regions = mowing::ExactOffsetCalculator::ConicPolygonVector();
+    calculator.polygon_set.polygons_with_holes(std::back_inserter(regions));
+
+    double area = 0;
+    for (auto &region: regions) {
+        area += CGAL::to_double(CGAL::abs(mowing::utils::approximate_polygon(region.outer_boundary()).area()));
+        for (auto &hole: region.holes()) {
+            area -= CGAL::to_double(CGAL::abs(mowing::utils::approximate_polygon(hole).area()));
+        }
+    }
+    return area;
+}
+
+/**
+ * Computes the number of uncovered regions with and without the circle-segment fast path.
+ */
+std::pair<std::size_t, std::size_t> count_uncovered_regions(std::vector<Input_Point> tour, double radius) {
+    auto polygon = polygon_from_cgal_string("4 0 0 0 2 10 2 10 0");
+    auto exact = mowing::ExactOffsetCalculator(polygon, radius, false, false);
+    auto fast = mowing::ExactOffsetCalculator(polygon, radius, false, true);
+
+    exact.computeUncoveredRegions(tour);
+    fast.computeUncoveredRegions(tour);
+
+    return {exact.polygon_set.number_of_polygons_with_holes(), fast.polygon_set.number_of_polygons_with_holes()};
+}
+
+BOOST_AUTO_TEST_CASE(fast_path_certifies_coverage)
+{
+    auto tour = std::vector<Input_Point>{{1, 0.9}, {9, 0.9}, {5, 1.1}};
+    auto counts = count_uncovered_regions(tour, 1.5);
+
+    BOOST_CHECK_EQUAL(counts.first, 0);
+    BOOST_CHECK_EQUAL(counts.second, 0);
+}
+
+BOOST_AUTO_TEST_CASE(fast_path_matches_exact_uncovered_regions)
+{
+    auto tour = std::vector<Input_Point>{{1, 0.9}, {9, 0.9}, {5, 1.1}};
+    auto counts = count_uncovered_regions(tour, 0.5);
+
+    BOOST_CHECK_GT(counts.first, 0);
+    BOOST_CHECK_EQUAL(counts.first, counts.second);
+}
+
+BOOST_AUTO_TEST_CASE(fast_path_matches_exact_for_antenna)
+{
+    auto tour = std::vector<Input_Point>{{1, 1}, {9, 1}};
+    auto covered = count_uncovered_regions(tour, 1.5);
+    auto uncovered = count_uncovered_regions(tour, 0.9);
+
+    BOOST_CHECK_EQUAL(covered.first, covered.second);
+    BOOST_CHECK_EQUAL(uncovered.first, uncovered.second);
+}
+
+BOOST_AUTO_TEST_CASE(fast_path_matches_exact_area_on_instances)
+{
+    // The boundary of the polygon as tour leaves the inside uncovered for small radii and nothing for large ones.
+    for (const auto &name: {"small/srpg_iso0000017.poly", "small/srpg_iso0000025.poly",
+                            "small/srpg_iso0000039.poly"}) {
+        auto polygon = read_instance(name);
+        auto tour = std::vector<Input_Point>(polygon.vertices_begin(), polygon.vertices_end());
+        auto bbox = polygon.bbox();
+        auto size = std::max(bbox.xmax() - bbox.xmin(), bbox.ymax() - bbox.ymin());
+        auto polygon_area = CGAL::to_double(CGAL::abs(polygon.area()));
+
+        for (auto factor: {0.05, 0.2, 1.0}) {
+            BOOST_TEST_CONTEXT(name << " with radius " << factor * size) {
+                auto exact = mowing::ExactOffsetCalculator(polygon, factor * size, false, false);
+                auto fast = mowing::ExactOffsetCalculator(polygon, factor * size, false, true);
+                exact.computeUncoveredRegions(tour);
+                fast.computeUncoveredRegions(tour);
+
+                auto exact_area = uncovered_area(exact);
+                BOOST_CHECK_EQUAL(exact.polygon_set.number_of_polygons_with_holes(),
+                                  fast.polygon_set.number_of_polygons_with_holes());
+                BOOST_CHECK_SMALL(exact_area - uncovered_area(fast), 1e-6 * polygon_area);
+                if (factor == 0.05) {
+                    BOOST_CHECK_GT(exact_area, 0);
+                } else if (factor == 1.0) {
+                    BOOST_CHECK_EQUAL(exact_area, 0);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(tiling_matches_exact_uncovered_regions)
+{
+    auto polygon = polygon_from_cgal_string("4 0 0 0 2 10 2 10 0");
+    auto tour = std::vector<Input_Point>{{1, 0.9}, {9, 0.9}, {5, 1.1}};
+    auto exact = mowing::ExactOffsetCalculator(polygon, 0.5, false, false);
+    auto tiled = mowing::ExactOffsetCalculator(polygon, 0.5, false, false);
+    tiled.enableTiling(4, 2, 4);
+
+    exact.computeUncoveredRegions(tour);
+    tiled.computeUncoveredRegions(tour);
+
+    BOOST_CHECK_GT(exact.polygon_set.number_of_polygons_with_holes(), 0);
+    BOOST_CHECK_EQUAL(exact.polygon_set.number_of_polygons_with_holes(),
+                      tiled.polygon_set.number_of_polygons_with_holes());
+    BOOST_CHECK_SMALL(uncovered_area(exact) - uncovered_area(tiled), 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(tiling_matches_exact_area_on_instance)
+{
+    // The boundary tour reaches all tiles, so it is split into its edges.
+    auto polygon = read_instance("small/srpg_iso0000039.poly");
+    auto tour = std::vector<Input_Point>(polygon.vertices_begin(), polygon.vertices_end());
+    auto bbox = polygon.bbox();
+    auto radius = 0.05 * std::max(bbox.xmax() - bbox.xmin(), bbox.ymax() - bbox.ymin());
+    auto exact = mowing::ExactOffsetCalculator(polygon, radius, false, false);
+    auto tiled = mowing::ExactOffsetCalculator(polygon, radius, false, false);
+    tiled.enableTiling(3, 3, 4);
+
+    exact.computeUncoveredRegions(tour);
+    tiled.computeUncoveredRegions(tour);
+
+    BOOST_CHECK_EQUAL(exact.polygon_set.number_of_polygons_with_holes(),
+                      tiled.polygon_set.number_of_polygons_with_holes());
+    BOOST_CHECK_SMALL(uncovered_area(exact) - uncovered_area(tiled), 1e-6 * CGAL::to_double(CGAL::abs(polygon.area())));
+}
+
+/**
+ * Exposes the insertion of subtours of the solver.
+ */
+struct SubtourInsertion : public mowing::MowingSolverWithUpperBound {
+    using mowing::MowingSolverWithUpperBound::insertSubtour;
+};
+
+BOOST_AUTO_TEST_CASE(subtracting_added_subtours_matches_extended_tour)
+{
+    auto polygon = polygon_from_cgal_string("4 0 0 20 0 20 20 0 20");
+    auto tour = std::vector<Input_Point>{{2, 2}, {10, 2}, {10, 10}, {2, 10}};
+    auto incremental = mowing::ExactOffsetCalculator(polygon, 1, false, false);
+    incremental.computeUncoveredRegions(tour);
+
+    // One subtour starts at a vertex of the tour, the other one on an edge.
+    auto at_vertex = std::vector<Input_Point>{{10, 10}, {18, 18}, {10, 18}};
+    auto on_edge = std::vector<Input_Point>{{6, 2}, {18, 1}, {18, 8}};
+    auto added_subtours = std::vector<std::vector<Input_Point>>();
+    added_subtours.push_back(SubtourInsertion::insertSubtour(tour, at_vertex, Input_Point(10, 10)));
+    added_subtours.push_back(SubtourInsertion::insertSubtour(tour, on_edge, Input_Point(6, 2)));
+    BOOST_REQUIRE_EQUAL(added_subtours[0].size(), 4);
+    BOOST_REQUIRE_EQUAL(added_subtours[1].size(), 4);
+    // The closing point is already in the tour for a vertex, but not for an edge.
+    BOOST_REQUIRE_EQUAL(tour.size(), 4 + 3 + 4);
+
+    incremental.subtractAddedSubtours(added_subtours);
+    auto full = mowing::ExactOffsetCalculator(polygon, 1, false, false);
+    full.computeUncoveredRegions(tour);
+
+    BOOST_CHECK_GT(uncovered_area(full), 0);
+    BOOST_CHECK_EQUAL(incremental.polygon_set.number_of_polygons_with_holes(),
+                      full.polygon_set.number_of_polygons_with_holes());
+    BOOST_CHECK_SMALL(uncovered_area(incremental) - uncovered_area(full), 1e-6);
+}
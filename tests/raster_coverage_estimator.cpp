@@ -0,0 +1,62 @@
+#define BOOST_TEST_MODULE raster_coverage_estimator
+
+#include <boost/test/included/unit_test.hpp>
+#include "mowing/RasterCoverageEstimator.h"
+
+using namespace boost::unit_test;
+
+Polygon_2 l_shape() {
+    Polygon_2 polygon;
+    polygon.push_back(Point(0, 0));
+    polygon.push_back(Point(10, 0));
+    polygon.push_back(Point(10, 4));
+    polygon.push_back(Point(4, 4));
+    polygon.push_back(Point(4, 10));
+    polygon.push_back(Point(0, 10));
+    return polygon;
+}
+
+BOOST_AUTO_TEST_CASE(uncovered_region_of_partial_tour)
+{
+    auto polygon = l_shape();
+    auto estimator = mowing::RasterCoverageEstimator(polygon, 1.5, 100);
+
+    // Covers the horizontal leg, but not the vertical one.
+    auto tour = mowing::RasterCoverageEstimator::PointVector{Point(1, 1), Point(9, 1), Point(9, 3), Point(1, 3)};
+    auto estimate = estimator.estimate(tour);
+    BOOST_REQUIRE(estimate.regions.size() == 1);
+    BOOST_TEST(!estimate.isProbablyCovered());
+
+    auto &region = estimate.regions.front();
+    BOOST_TEST(region.distances.size() == region.cells.size());
+    BOOST_TEST(region.farthest_distance > 5);
+    BOOST_TEST(region.area > 4 * 5);
+    BOOST_TEST(region.area < 4 * 6);
+
+    // The outline encloses the uncovered leg and has no collinear vertices.
+    auto boundary = estimator.outerBoundary(region);
+    BOOST_TEST(boundary.is_simple());
+    BOOST_TEST(boundary.is_counterclockwise_oriented());
+    BOOST_TEST(boundary.bounded_side(Point(2, 8)) == CGAL::ON_BOUNDED_SIDE);
+    BOOST_TEST(boundary.bounded_side(Point(8, 2)) == CGAL::ON_UNBOUNDED_SIDE);
+    auto it = boundary.vertices_circulator();
+    do {
+        BOOST_TEST(!CGAL::collinear(*std::prev(it), *it, *std::next(it)));
+    } while (++it != boundary.vertices_circulator());
+
+    for (auto &witness: estimator.placeWitnesses(region, 5)) {
+        BOOST_TEST(polygon.bounded_side(witness) == CGAL::ON_BOUNDED_SIDE);
+        BOOST_TEST(CGAL::to_double(witness.y()) > 4);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(covering_tour)
+{
+    auto polygon = l_shape();
+    auto estimator = mowing::RasterCoverageEstimator(polygon, 1.5, 100);
+    auto tour = mowing::RasterCoverageEstimator::PointVector{Point(1, 1), Point(9, 1), Point(9, 3), Point(3, 3),
+                                                             Point(3, 9), Point(1, 9)};
+    auto estimate = estimator.estimate(tour);
+    BOOST_TEST(estimate.isProbablyCovered());
+    BOOST_TEST(estimate.uncovered_area == 0);
+}